@@ -53,13 +53,8 @@ void CalFineTime::Calib()
   }
 }
 
-double CalFineTime::Get(uint32_t a_i)
+void CalFineTime::Add(uint32_t a_i)
 {
-  if (0x3ff == a_i) {
-    // Magical Tamex fine time...
-    return 0.0;
-  }
-
   // Pick span, swap if we've reached ~10%.
   Span *span = &m_span_vec[m_span_i];
   if (span->sum > 1000 &&
@@ -98,9 +93,28 @@ double CalFineTime::Get(uint32_t a_i)
       10000 == m_counter) {
     Calib();
   }
+}
+
+void CalFineTime::CopyCalib(CalFineTime const &a_cal)
+{
+  m_acc_max = a_cal.m_acc_max;
+  m_acc_sum = a_cal.m_acc_sum;
+  m_acc = a_cal.m_acc;
+}
 
-  // Convert.
-  if (m_acc.empty()) {
+double CalFineTime::Get(uint32_t a_i)
+{
+  if (0x3ff == a_i) {
+    // Magical Tamex fine time...
+    return 0.0;
+  }
+  Add(a_i);
+  return Lookup(a_i);
+}
+
+double CalFineTime::Lookup(uint32_t a_i) const
+{
+  if (0x3ff == a_i || m_acc.empty()) {
     return 0.0;
   }
   a_i = std::min(a_i, m_acc_max);
@@ -31,11 +31,15 @@
  *
  * Calibrations are double-buffered, so in the beginning the fine-time is
  * slowly building, and eventually old calibrations are discarded.
+ * Get = Add + Lookup, and CopyCalib gives a calibrator which only looks up.
  */
 class CalFineTime {
   public:
     CalFineTime();
+    void Add(uint32_t);
+    void CopyCalib(CalFineTime const &);
     double Get(uint32_t);
+    double Lookup(uint32_t) const;
 
   private:
     void Calib();
@@ -0,0 +1,390 @@
+/*
+ * plutt, a scriptable monitor for experimental data.
+ *
+ * Copyright (C) 2023  Hans Toshihide Toernqvist <hans.tornqvist@chalmers.se>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301  USA
+ */
+
+#include <column_cache.hpp>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <config.hpp>
+
+#define COLUMN_MAGIC "PLUTTCC1"
+#define COLUMN_HEADER_BYTES 16
+
+namespace {
+
+  std::string ColumnPath(std::string const &a_dir, std::string const
+      &a_name, std::string const &a_suffix)
+  {
+    auto path = a_dir + '/' + a_name;
+    if (!a_suffix.empty()) {
+      path += '.' + a_suffix;
+    }
+    return path;
+  }
+
+  // Splits "name[.suffix].dat", false for anything else.
+  bool ColumnParse(char const *a_file, std::string *a_name, std::string
+      *a_suffix)
+  {
+    auto len = strlen(a_file);
+    if (len <= 4 || 0 != strcmp(a_file + len - 4, ".dat")) {
+      return false;
+    }
+    std::string base(a_file, len - 4);
+    auto dot = base.find('.');
+    *a_name = base.substr(0, dot);
+    *a_suffix = std::string::npos == dot ? "" : base.substr(dot + 1);
+    return true;
+  }
+
+  // Column base paths in the cache, keyed by signal name.
+  std::multimap<std::string, std::string> ColumnList(std::string const
+      &a_dir)
+  {
+    std::multimap<std::string, std::string> map;
+    auto dir = opendir(a_dir.c_str());
+    if (!dir) {
+      return map;
+    }
+    for (;;) {
+      auto ent = readdir(dir);
+      if (!ent) {
+        break;
+      }
+      std::string name, suffix;
+      if (ColumnParse(ent->d_name, &name, &suffix)) {
+        map.insert(std::make_pair(name, suffix));
+      }
+    }
+    closedir(dir);
+    return map;
+  }
+
+  void const *ColumnMap(std::string const &a_path, size_t *a_size)
+  {
+    auto fd = open(a_path.c_str(), O_RDONLY);
+    if (-1 == fd) {
+      perror("open");
+      std::cerr << a_path << ": Could not open column.\n";
+      throw std::runtime_error(__func__);
+    }
+    struct stat st;
+    if (-1 == fstat(fd, &st)) {
+      perror("fstat");
+      close(fd);
+      throw std::runtime_error(__func__);
+    }
+    *a_size = (size_t)st.st_size;
+    if (0 == *a_size) {
+      close(fd);
+      return nullptr;
+    }
+    auto map = mmap(nullptr, *a_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (MAP_FAILED == map) {
+      perror("mmap");
+      std::cerr << a_path << ": Could not map column.\n";
+      throw std::runtime_error(__func__);
+    }
+    // Events are consumed in order, let the kernel read ahead in big
+    // batches.
+    madvise(map, *a_size, MADV_SEQUENTIAL);
+    madvise(map, *a_size, MADV_WILLNEED);
+    return map;
+  }
+
+}
+
+ColumnCacheWriter::Column::Column(std::string const &a_path, size_t a_id):
+  path(a_path),
+  id(a_id),
+  dat(),
+  ofs(),
+  end()
+{
+}
+
+ColumnCacheWriter::ColumnCacheWriter(Config const &a_config, char const
+    *a_dir):
+  m_dir(a_dir),
+  m_column_vec(),
+  m_event_n(),
+  m_cached_event_n((uint64_t)-1)
+{
+  if (-1 == mkdir(a_dir, 0777) && EEXIST != errno) {
+    perror("mkdir");
+    std::cerr << a_dir << ": Could not create cache.\n";
+    throw std::runtime_error(__func__);
+  }
+  auto cached = ColumnList(m_dir);
+  if (!cached.empty()) {
+    auto const &first = *cached.begin();
+    struct stat st;
+    auto path = ColumnPath(m_dir, first.first, first.second) + ".ofs";
+    if (-1 == stat(path.c_str(), &st)) {
+      perror("stat");
+      std::cerr << path << ": Broken cache.\n";
+      throw std::runtime_error(__func__);
+    }
+    m_cached_event_n = (uint64_t)st.st_size / sizeof(uint64_t);
+  }
+  auto const &binding_vec = a_config.GetBindingVec();
+  for (auto it = binding_vec.begin(); binding_vec.end() != it; ++it) {
+    if (cached.count(it->name)) {
+      continue;
+    }
+    auto col = new Column(ColumnPath(m_dir, it->name, it->suffix), it->id);
+    m_column_vec.push_back(col);
+    auto dat_path = col->path + ".dat.tmp";
+    auto ofs_path = col->path + ".ofs.tmp";
+    col->dat = fopen(dat_path.c_str(), "wb");
+    col->ofs = fopen(ofs_path.c_str(), "wb");
+    if (!col->dat || !col->ofs) {
+      perror("fopen");
+      std::cerr << col->path << ": Could not open column.\n";
+      throw std::runtime_error(__func__);
+    }
+    Put(col->dat, dat_path, COLUMN_MAGIC, 8);
+    uint64_t type = it->type;
+    Put(col->dat, dat_path, &type, sizeof type);
+  }
+  if (!m_column_vec.empty()) {
+    std::cout << a_dir << ": Caching " << m_column_vec.size() <<
+        " signal members.\n";
+  }
+}
+
+ColumnCacheWriter::~ColumnCacheWriter()
+{
+  // Columns still open were never committed, drop them.
+  for (auto it = m_column_vec.begin(); m_column_vec.end() != it; ++it) {
+    auto col = *it;
+    if (col->dat) {
+      fclose(col->dat);
+      unlink((col->path + ".dat.tmp").c_str());
+    }
+    if (col->ofs) {
+      fclose(col->ofs);
+      unlink((col->path + ".ofs.tmp").c_str());
+    }
+    delete col;
+  }
+}
+
+void ColumnCacheWriter::Commit()
+{
+  if (m_column_vec.empty()) {
+    return;
+  }
+  if ((uint64_t)-1 != m_cached_event_n && m_event_n != m_cached_event_n) {
+    std::cerr << m_dir << ": Input gave " << m_event_n <<
+        " events but cache has " << m_cached_event_n <<
+        ", not adding columns.\n";
+    return;
+  }
+  for (auto it = m_column_vec.begin(); m_column_vec.end() != it; ++it) {
+    auto col = *it;
+    if (0 != fclose(col->dat) || 0 != fclose(col->ofs)) {
+      perror("fclose");
+    }
+    col->dat = nullptr;
+    col->ofs = nullptr;
+    if (0 != rename((col->path + ".dat.tmp").c_str(),
+        (col->path + ".dat").c_str()) ||
+        0 != rename((col->path + ".ofs.tmp").c_str(),
+        (col->path + ".ofs").c_str())) {
+      perror("rename");
+      std::cerr << col->path << ": Could not commit column.\n";
+    }
+  }
+  std::cout << m_dir << ": Cached " << m_column_vec.size() <<
+      " signal members over " << m_event_n << " events.\n";
+}
+
+void ColumnCacheWriter::Put(FILE *a_file, std::string const &a_path, void
+    const *a_p, size_t a_bytes)
+{
+  if (0 == a_bytes) {
+    return;
+  }
+  if (1 != fwrite(a_p, a_bytes, 1, a_file)) {
+    perror("fwrite");
+    std::cerr << a_path << ": Could not write.\n";
+    throw std::runtime_error(__func__);
+  }
+}
+
+void ColumnCacheWriter::Write(Input *a_input, unsigned a_slot)
+{
+  for (auto it = m_column_vec.begin(); m_column_vec.end() != it; ++it) {
+    auto col = *it;
+    auto data = a_input->GetData(a_slot, col->id);
+    Put(col->dat, col->path, data.first, data.second *
+        sizeof(Input::Scalar));
+    col->end += data.second;
+    Put(col->ofs, col->path, &col->end, sizeof col->end);
+  }
+  ++m_event_n;
+}
+
+ColumnCache::Column::Column():
+  dat_map(),
+  dat_size(),
+  ofs_map(),
+  ofs_size(),
+  scalar(),
+  end()
+{
+}
+
+ColumnCache::ColumnCache(Config &a_config, unsigned a_slot_num, char const
+    *a_dir):
+  m_dir(a_dir),
+  m_column_vec(),
+  m_event_n((uint64_t)-1),
+  m_event_i(),
+  m_slot_event_vec(a_slot_num)
+{
+  try {
+    Bind(a_config);
+  } catch (...) {
+    // The destructor will not run for a half-built object.
+    Unmap();
+    throw;
+  }
+  std::cout << a_dir << ": Reading " << m_column_vec.size() <<
+      " signal members over " << m_event_n << " events.\n";
+}
+
+ColumnCache::~ColumnCache()
+{
+  Unmap();
+}
+
+void ColumnCache::Bind(Config &a_config)
+{
+  auto signal_list = a_config.GetSignalList();
+  std::set<std::string> signal_set(signal_list.begin(), signal_list.end());
+  auto cached = ColumnList(m_dir);
+  for (auto it = cached.begin(); cached.end() != it; ++it) {
+    if (!signal_set.count(it->first)) {
+      continue;
+    }
+    auto path = ColumnPath(m_dir, it->first, it->second);
+    auto col = new Column;
+    m_column_vec.push_back(col);
+    col->dat_map = ColumnMap(path + ".dat", &col->dat_size);
+    col->ofs_map = ColumnMap(path + ".ofs", &col->ofs_size);
+    if (col->dat_size < COLUMN_HEADER_BYTES ||
+        0 != memcmp(col->dat_map, COLUMN_MAGIC, 8)) {
+      std::cerr << path << ": Not a column.\n";
+      throw std::runtime_error(__func__);
+    }
+    auto header = (uint64_t const *)col->dat_map;
+    col->scalar = (Input::Scalar const *)&header[2];
+    col->end = (uint64_t const *)col->ofs_map;
+    uint64_t event_n = col->ofs_size / sizeof(uint64_t);
+    if ((uint64_t)-1 == m_event_n) {
+      m_event_n = event_n;
+    } else if (event_n != m_event_n) {
+      std::cerr << path << ": Has " << event_n << " events, expected " <<
+          m_event_n << ".\n";
+      throw std::runtime_error(__func__);
+    }
+    a_config.BindSignal(it->first, it->second.c_str(),
+        m_column_vec.size() - 1, (Input::Type)header[1]);
+  }
+  for (auto it = signal_set.begin(); signal_set.end() != it; ++it) {
+    if (!cached.count(*it)) {
+      std::cerr << *it << ": Signal not in cache.\n";
+      throw std::runtime_error(__func__);
+    }
+  }
+  if (m_column_vec.empty()) {
+    m_event_n = 0;
+  }
+}
+
+void ColumnCache::Buffer(unsigned a_slot)
+{
+  // Columns are looked up lazily, only remember the event.
+  m_slot_event_vec.at(a_slot) = m_event_i - 1;
+}
+
+bool ColumnCache::Covers(Config const &a_config, char const *a_dir)
+{
+  auto cached = ColumnList(a_dir);
+  auto signal_list = a_config.GetSignalList();
+  for (auto it = signal_list.begin(); signal_list.end() != it; ++it) {
+    if (!cached.count(*it)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ColumnCache::Fetch()
+{
+  if (m_event_i >= m_event_n) {
+    return false;
+  }
+  ++m_event_i;
+  return true;
+}
+
+std::pair<Input::Scalar const *, size_t> ColumnCache::GetData(unsigned
+    a_slot, size_t a_id)
+{
+  auto col = m_column_vec.at(a_id);
+  auto event_i = m_slot_event_vec.at(a_slot);
+  uint64_t begin = 0 == event_i ? 0 : col->end[event_i - 1];
+  uint64_t end = col->end[event_i];
+  uint64_t scalar_n = (col->dat_size - COLUMN_HEADER_BYTES) /
+      sizeof(Input::Scalar);
+  if (begin > end || end > scalar_n) {
+    std::cerr << m_dir << ": Corrupt column " << a_id << " at event " <<
+        event_i << ".\n";
+    throw std::runtime_error(__func__);
+  }
+  return std::make_pair(col->scalar + begin, end - begin);
+}
+
+void ColumnCache::Unmap()
+{
+  for (auto it = m_column_vec.begin(); m_column_vec.end() != it; ++it) {
+    auto col = *it;
+    if (col->dat_map) {
+      munmap((void *)col->dat_map, col->dat_size);
+    }
+    if (col->ofs_map) {
+      munmap((void *)col->ofs_map, col->ofs_size);
+    }
+    delete col;
+  }
+}
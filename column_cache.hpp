@@ -0,0 +1,123 @@
+/*
+ * plutt, a scriptable monitor for experimental data.
+ *
+ * Copyright (C) 2023  Hans Toshihide Toernqvist <hans.tornqvist@chalmers.se>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301  USA
+ */
+
+#ifndef COLUMN_CACHE_HPP
+#define COLUMN_CACHE_HPP
+
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+#include <input.hpp>
+
+class Config;
+
+/*
+ * Columnar cache of bound signals, for re-analysing the same run many times
+ * with only a few of its signals.
+ * A cache is a directory with two files per bound member, named after the
+ * signal and member suffix, eg "x.I.dat" and "x.I.ofs" ("x.dat" for the
+ * plain member):
+ *  .dat: magic "PLUTTCC1", 64-bit type, then the scalars of all events.
+ *  .ofs: 64-bit end offset in scalars per event, the size gives the number
+ *  of events.
+ * A pass over an input writes the signals the cache does not have yet into
+ * temporaries, which are renamed into place only when the input is drained
+ * and the event count agrees with the columns already there.
+ */
+
+/*
+ * Writes the members of uncached signals, see Write and Commit.
+ */
+class ColumnCacheWriter {
+  public:
+    ColumnCacheWriter(Config const &, char const *);
+    ~ColumnCacheWriter();
+    // Call from the thread which owns the slot, after Input::Buffer.
+    void Write(Input *, unsigned);
+    // Call when the input is drained.
+    void Commit();
+
+  private:
+    ColumnCacheWriter(ColumnCacheWriter const &);
+    ColumnCacheWriter &operator=(ColumnCacheWriter const &);
+    void Put(FILE *, std::string const &, void const *, size_t);
+
+    struct Column {
+      Column(std::string const &, size_t);
+      std::string path;
+      size_t id;
+      FILE *dat;
+      FILE *ofs;
+      uint64_t end;
+      private:
+      Column(Column const &);
+      Column &operator=(Column const &);
+    };
+    std::string m_dir;
+    std::vector<Column *> m_column_vec;
+    uint64_t m_event_n;
+    // Events in the existing columns, or ~0 if there are none.
+    uint64_t m_cached_event_n;
+};
+
+/*
+ * Feeds the columns the config needs, through mmap.
+ * The unsigned is the number of output slots, see input.hpp.
+ */
+class ColumnCache: public Input {
+  public:
+    ColumnCache(Config &, unsigned, char const *);
+    ~ColumnCache();
+    void Buffer(unsigned);
+    bool Fetch();
+    std::pair<Input::Scalar const *, size_t> GetData(unsigned, size_t);
+
+    // True if the cache has columns for all signals of the config.
+    static bool Covers(Config const &, char const *);
+
+  private:
+    ColumnCache(ColumnCache const &);
+    ColumnCache &operator=(ColumnCache const &);
+    void Bind(Config &);
+    void Unmap();
+
+    struct Column {
+      Column();
+      void const *dat_map;
+      size_t dat_size;
+      void const *ofs_map;
+      size_t ofs_size;
+      Input::Scalar const *scalar;
+      uint64_t const *end;
+      private:
+      Column(Column const &);
+      Column &operator=(Column const &);
+    };
+    std::string m_dir;
+    std::vector<Column *> m_column_vec;
+    uint64_t m_event_n;
+    // Event index of the last fetch, and of every slot.
+    uint64_t m_event_i;
+    std::vector<uint64_t> m_slot_event_vec;
+};
+
+#endif
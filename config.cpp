@@ -61,7 +61,8 @@ extern int yycpparse();
 
 extern char const *yycppath;
 
-Config::Config(char const *a_path):
+Config::Config(char const *a_path, Config *a_primary):
+  m_primary(a_primary),
   m_path(a_path),
   m_line(),
   m_col(),
@@ -74,11 +75,17 @@ Config::Config(char const *a_path):
   m_cut_poly_list(),
   m_cut_ref_map(),
   m_fit_map(),
+  m_binding_vec(),
+  m_stateful_vec(),
+  m_schedule_vec(),
+  m_event_filter(),
+  m_filter_schedule_vec(),
   m_clock_match(),
   m_colormap(ImPlutt::ColormapGet(nullptr)),
   m_ui_rate(DEFAULT_UI_RATE),
   m_evid(),
-  m_input()
+  m_input(),
+  m_input_slot()
 {
   // config_parser relies on this global!
   g_config = this;
@@ -107,9 +114,6 @@ Config::Config(char const *a_path):
       m_signal_map.insert(std::make_pair(it->first, signal));
     }
   }
-  for (auto it = m_signal_map.begin(); m_signal_map.end() != it; ++it) {
-    std::cout << "Signal=" << it->first << '\n';
-  }
 
   if (!m_cut_poly_list.empty()) {
     throw std::runtime_error(__func__);
@@ -144,6 +148,21 @@ Config::Config(char const *a_path):
     }
   }
   m_cut_ref_map.clear();
+
+  Schedule();
+  if (!m_primary) {
+    for (auto it = m_signal_map.begin(); m_signal_map.end() != it; ++it) {
+      std::cout << "Signal=" << it->first << '\n';
+    }
+  }
+
+  if (m_primary) {
+    // The input was bound to the primary, same story here.
+    auto const &binding_vec = m_primary->m_binding_vec;
+    for (auto it = binding_vec.begin(); binding_vec.end() != it; ++it) {
+      BindSignal(it->name, it->suffix.c_str(), it->id, it->type);
+    }
+  }
 }
 
 Config::~Config()
@@ -216,8 +235,11 @@ NodeValue *Config::AddCoarseFine(NodeValue *a_coarse, NodeValue *a_fine,
   auto key = oss.str();
   auto node = NodeValueGet(key);
   if (!node) {
-    NodeValueAdd(key, node = new NodeCoarseFine(GetLocStr(), a_coarse, a_fine,
-        a_fine_range));
+    auto coarse_fine = new NodeCoarseFine(GetLocStr(), a_coarse, a_fine,
+        a_fine_range);
+    coarse_fine->SetPrimary(
+        static_cast<NodeCoarseFine *>(StatefulAdd(coarse_fine)));
+    NodeValueAdd(key, node = coarse_fine);
   }
   return node;
 }
@@ -279,8 +301,13 @@ void Config::AddHist1(char const *a_title, NodeValue *a_x, uint32_t a_xb, char
     k = it->second.k;
     m = it->second.m;
   }
+  NodeHist1 *primary = nullptr;
+  if (m_primary) {
+    primary = static_cast<NodeHist1 *>(m_primary->m_cuttable_map.at(a_title));
+  }
   auto node = new NodeHist1(GetLocStr(), a_title,
-      a_x, a_xb, LinearTransform(k, m), a_fit, a_log_y, a_drop_old_s);
+      a_x, a_xb, LinearTransform(k, m), a_fit, a_log_y, a_drop_old_s,
+      primary);
   NodeCuttableAdd(node);
 }
 
@@ -312,9 +339,13 @@ void Config::AddHist2(char const *a_title, NodeValue *a_y, NodeValue *a_x,
     ky = it->second.k;
     my = it->second.m;
   }
+  NodeHist2 *primary = nullptr;
+  if (m_primary) {
+    primary = static_cast<NodeHist2 *>(m_primary->m_cuttable_map.at(a_title));
+  }
   auto node = new NodeHist2(GetLocStr(), a_title, m_colormap,
       a_y, a_x, a_yb, a_xb, LinearTransform(ky, my), LinearTransform(kx, mx),
-      a_fit, a_log_z, a_drop_old_s);
+      a_fit, a_log_z, a_drop_old_s, primary);
   NodeCuttableAdd(node);
 }
 
@@ -419,7 +450,9 @@ NodeValue *Config::AddMExpr(NodeValue *a_l, NodeValue *a_r, double a_d,
 
 void Config::AddPage(char const *a_label)
 {
-  plot_page_create(a_label);
+  if (!m_primary) {
+    plot_page_create(a_label);
+  }
 }
 
 NodeValue *Config::AddPedestal(NodeValue *a_value, double a_cutoff, NodeValue
@@ -430,8 +463,9 @@ NodeValue *Config::AddPedestal(NodeValue *a_value, double a_cutoff, NodeValue
   auto key = oss.str();
   auto node = NodeValueGet(key);
   if (!node) {
-    NodeValueAdd(key,
-        node = new NodePedestal(GetLocStr(), a_value, a_cutoff, a_tpat));
+    auto pedestal = new NodePedestal(GetLocStr(), a_value, a_cutoff, a_tpat);
+    pedestal->SetPrimary(static_cast<NodePedestal *>(StatefulAdd(pedestal)));
+    NodeValueAdd(key, node = pedestal);
   }
   return node;
 }
@@ -530,6 +564,14 @@ void Config::BindSignal(std::string const &a_name, char const *a_suffix,
   }
   auto signal = it->second;
   signal->BindSignal(a_suffix ? a_suffix : "", a_id, a_type);
+
+  m_binding_vec.push_back(Binding(a_name, a_suffix ? a_suffix : "", a_id,
+      a_type));
+}
+
+std::vector<Config::Binding> const &Config::GetBindingVec() const
+{
+  return m_binding_vec;
 }
 
 void Config::AppearanceSet(char const *a_name)
@@ -552,6 +594,15 @@ void Config::ClockMatch(NodeValue *a_value, double a_s_from_ts)
   m_clock_match.s_from_ts = a_s_from_ts;
 }
 
+void Config::EventFilter(NodeValue *a_value)
+{
+  if (m_event_filter) {
+    std::cerr << GetLocStr() << ": Only one event_filter allowed.\n";
+    throw std::runtime_error(__func__);
+  }
+  m_event_filter = a_value;
+}
+
 void Config::ColormapSet(char const *a_name)
 {
   try {
@@ -618,9 +669,22 @@ NodeValue *Config::NodeValueGet(std::string const &a_key)
   return it->second;
 }
 
-void Config::DoEvent(Input *a_input)
+NodeValue *Config::StatefulAdd(NodeValue *a_node)
+{
+  // Returns the node which should hold the state, ie the node itself for the
+  // primary config, or the primary's node at the same creation index.
+  auto primary = a_node;
+  if (m_primary) {
+    primary = m_primary->m_stateful_vec.at(m_stateful_vec.size());
+  }
+  m_stateful_vec.push_back(a_node);
+  return primary;
+}
+
+void Config::DoEvent(Input *a_input, unsigned a_slot)
 {
   m_input = a_input;
+  m_input_slot = a_slot;
 
   if (m_clock_match.node) {
     // Match virtual event-rate with given signal.
@@ -668,8 +732,8 @@ void Config::DoEvent(Input *a_input)
     auto node = it->second;
     node->CutReset();
   }
-  for (auto it = m_cuttable_map.begin(); m_cuttable_map.end() != it; ++it) {
-    auto node = it->second;
+  for (auto it = m_schedule_vec.begin(); m_schedule_vec.end() != it; ++it) {
+    auto node = *it;
     node->Process(m_evid);
   }
 
@@ -677,6 +741,27 @@ void Config::DoEvent(Input *a_input)
   ++m_evid;
 }
 
+bool Config::DoFilter(Input *a_input, unsigned a_slot)
+{
+  if (!m_event_filter) {
+    return true;
+  }
+
+  m_input = a_input;
+  m_input_slot = a_slot;
+
+  auto const &schedule_vec = m_filter_schedule_vec;
+  for (auto it = schedule_vec.begin(); schedule_vec.end() != it; ++it) {
+    (*it)->Process(m_evid);
+  }
+  auto is_accepted = !m_event_filter->GetValue().GetV().empty();
+
+  m_input = nullptr;
+  ++m_evid;
+
+  return is_accepted;
+}
+
 std::string Config::GetLocStr() const
 {
   std::ostringstream oss;
@@ -705,6 +790,135 @@ Input *Config::GetInput()
   return m_input;
 }
 
+bool Config::HasClockMatch() const
+{
+  return nullptr != m_clock_match.node;
+}
+
+bool Config::HasEventFilter() const
+{
+  return nullptr != m_event_filter;
+}
+
+unsigned Config::GetInputSlot() const
+{
+  return m_input_slot;
+}
+
+// Flattens the node graph into m_schedule_vec, so that every node comes after
+// the nodes it depends on and DoEvent never recurses more than one level.
+// Everything hanging below a histogram with cuts stays lazy, since it should
+// only be processed when the cuts pass, and signals which no histogram uses
+// are dropped so the input doesn't have to provide them.
+void Config::Schedule()
+{
+  std::vector<Node *> root_vec;
+  if (m_clock_match.node) {
+    root_vec.push_back(m_clock_match.node);
+  }
+  for (auto it = m_cuttable_map.begin(); m_cuttable_map.end() != it; ++it) {
+    root_vec.push_back(it->second);
+  }
+
+  std::map<Node *, bool> visit_map;
+  for (auto it = root_vec.begin(); root_vec.end() != it; ++it) {
+    ScheduleLoopCheck(*it, &visit_map);
+  }
+  if (m_event_filter) {
+    ScheduleLoopCheck(m_event_filter, &visit_map);
+  }
+
+  std::set<Node *> schedule_set;
+  for (auto it = root_vec.begin(); root_vec.end() != it; ++it) {
+    ScheduleAdd(*it, &schedule_set, &m_schedule_vec);
+  }
+
+  // The filter runs on the input thread before anything else, so it cannot
+  // depend on histograms.
+  if (m_event_filter) {
+    std::set<Node *> filter_set;
+    auto &filter_vec = m_filter_schedule_vec;
+    ScheduleAdd(m_event_filter, &filter_set, &filter_vec);
+    for (auto it = filter_vec.begin(); filter_vec.end() != it; ++it) {
+      if (dynamic_cast<NodeCuttable *>(*it)) {
+        std::cerr << m_event_filter->GetLocStr() <<
+            ": event_filter cannot depend on histograms or cuts.\n";
+        throw std::runtime_error(__func__);
+      }
+    }
+  }
+
+  size_t drop_n = 0;
+  for (auto it = m_signal_map.begin(); m_signal_map.end() != it;) {
+    // The map covers all nodes reachable from the roots, lazy or not.
+    if (visit_map.end() == visit_map.find(it->second)) {
+      delete it->second;
+      it = m_signal_map.erase(it);
+      ++drop_n;
+    } else {
+      ++it;
+    }
+  }
+  if (!m_primary) {
+    std::cout << "Scheduled " << m_schedule_vec.size() << " nodes";
+    if (m_event_filter) {
+      std::cout << " (+" << m_filter_schedule_vec.size() <<
+          " for event_filter)";
+    }
+    if (drop_n) {
+      std::cout << ", dropped " << drop_n << " unused signals";
+    }
+    std::cout << ".\n";
+  }
+}
+
+void Config::ScheduleAdd(Node *a_node, std::set<Node *> *a_set,
+    std::vector<Node *> *a_schedule_vec)
+{
+  if (!a_set->insert(a_node).second) {
+    return;
+  }
+  auto cuttable = dynamic_cast<NodeCuttable *>(a_node);
+  if (cuttable && !cuttable->GetCutDepVec().empty()) {
+    auto const &dep_vec = cuttable->GetCutDepVec();
+    for (auto it = dep_vec.begin(); dep_vec.end() != it; ++it) {
+      ScheduleAdd(*it, a_set, a_schedule_vec);
+    }
+  } else {
+    auto const &dep_vec = a_node->GetDepVec();
+    for (auto it = dep_vec.begin(); dep_vec.end() != it; ++it) {
+      ScheduleAdd(*it, a_set, a_schedule_vec);
+    }
+  }
+  a_schedule_vec->push_back(a_node);
+}
+
+// Visits all deps, the bool is true while a node is on the stack.
+void Config::ScheduleLoopCheck(Node *a_node, std::map<Node *, bool>
+    *a_visit_map)
+{
+  auto ret = a_visit_map->insert(std::make_pair(a_node, true));
+  if (!ret.second) {
+    if (ret.first->second) {
+      std::cerr << a_node->GetLocStr() << ": Node loop!\n";
+      throw std::runtime_error(__func__);
+    }
+    return;
+  }
+  auto const &dep_vec = a_node->GetDepVec();
+  for (auto it = dep_vec.begin(); dep_vec.end() != it; ++it) {
+    ScheduleLoopCheck(*it, a_visit_map);
+  }
+  auto cuttable = dynamic_cast<NodeCuttable *>(a_node);
+  if (cuttable) {
+    auto const &cut_dep_vec = cuttable->GetCutDepVec();
+    for (auto it = cut_dep_vec.begin(); cut_dep_vec.end() != it; ++it) {
+      ScheduleLoopCheck(*it, a_visit_map);
+    }
+  }
+  ret.first->second = false;
+}
+
 void Config::SetLoc(int a_line, int a_col)
 {
   m_line = a_line;
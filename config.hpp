@@ -24,7 +24,9 @@
 
 #include <list>
 #include <map>
+#include <set>
 #include <string>
+#include <vector>
 #include <cut.hpp>
 #include <input.hpp>
 #include <node_mexpr.hpp>
@@ -43,10 +45,29 @@ class NodeValue;
 
 /*
  * Config, ie node graph builder.
+ * Every event thread gets its own node graph, the first config is the
+ * primary which creates all plots and every other config is a replica which
+ * is given the primary to share histograms and calibration state with.
  */
 class Config {
   public:
-    Config(char const *);
+    // Input signal member bound to an Input ID, see BindSignal.
+    struct Binding {
+      Binding(std::string const &a_name, std::string const &a_suffix, size_t
+          a_id, Input::Type a_type):
+        name(a_name),
+        suffix(a_suffix),
+        id(a_id),
+        type(a_type)
+      {
+      }
+      std::string name;
+      std::string suffix;
+      size_t id;
+      Input::Type type;
+    };
+
+    Config(char const *, Config *);
     ~Config();
 
     NodeValue *AddAlias(char const *, NodeValue *, uint32_t);
@@ -83,6 +104,7 @@ class Config {
     void AppearanceSet(char const *);
     void ClockMatch(NodeValue *, double);
     void ColormapSet(char const *);
+    void EventFilter(NodeValue *);
     void HistCutAdd(CutPolygon *);
     unsigned UIRateGet() const;
     void UIRateSet(unsigned);
@@ -91,10 +113,17 @@ class Config {
     void SetLoc(int, int);
 
     void BindSignal(std::string const &, char const *, size_t, Input::Type);
-    void DoEvent(Input *);
+    std::vector<Binding> const &GetBindingVec() const;
+    void DoEvent(Input *, unsigned);
+    // Runs only the event filter on a buffered event, returns true if the
+    // event should be processed.
+    bool DoFilter(Input *, unsigned);
     Input const *GetInput() const;
     Input *GetInput();
+    unsigned GetInputSlot() const;
     std::list<std::string> GetSignalList() const;
+    bool HasClockMatch() const;
+    bool HasEventFilter() const;
 
   private:
     Config(Config const &);
@@ -104,11 +133,16 @@ class Config {
     void NodeCuttableAdd(NodeCuttable *);
     void NodeValueAdd(std::string const &, NodeValue *);
     NodeValue *NodeValueGet(std::string const &);
+    void Schedule();
+    void ScheduleAdd(Node *, std::set<Node *> *, std::vector<Node *> *);
+    void ScheduleLoopCheck(Node *, std::map<Node *, bool> *);
+    NodeValue *StatefulAdd(NodeValue *);
 
     struct FitEntry {
       double k;
       double m;
     };
+    Config *m_primary;
     std::string m_path;
     int m_line, m_col;
     TrigMap m_trig_map;
@@ -129,6 +163,16 @@ class Config {
     CutPolyList m_cut_poly_list;
     std::map<std::string, CutPolyList> m_cut_ref_map;
     std::map<std::string, FitEntry> m_fit_map;
+    // Input bindings, replayed onto replicas.
+    std::vector<Binding> m_binding_vec;
+    // Nodes with state shared between event threads in creation order, the
+    // config is the same so replicas find the primary node by index.
+    std::vector<NodeValue *> m_stateful_vec;
+    // Live nodes in dependency order, DoEvent runs them front to back.
+    std::vector<Node *> m_schedule_vec;
+    // Scheduled on its own, the nodes are run by the input thread.
+    NodeValue *m_event_filter;
+    std::vector<Node *> m_filter_schedule_vec;
     struct {
       NodeValue *node;
       double s_from_ts;
@@ -140,6 +184,7 @@ class Config {
     unsigned m_ui_rate;
     uint64_t m_evid;
     Input *m_input;
+    unsigned m_input_slot;
 };
 
 #endif
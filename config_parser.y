@@ -145,6 +145,7 @@ static double g_drop_old = -1.0;
 %token TK_CTDC
 %token TK_CUT
 %token TK_DROP_OLD
+%token TK_EVENT_FILTER
 %token TK_EXP
 %token TK_FILTER_RANGE
 %token TK_FIT
@@ -229,6 +230,7 @@ stmt
 	| cluster
 	| colormap
 	| cut
+	| event_filter
 	| filter_range
 	| fit
 	| hist
@@ -310,6 +312,12 @@ cut
 		g_cut_poly = nullptr;
 	}
 
+event_filter
+	: TK_EVENT_FILTER '(' value ')' {
+		LOC_SAVE(@1);
+		g_config->EventFilter($3);
+	}
+
 page
 	: TK_PAGE '(' TK_STRING ')' {
 		g_config->AddPage($3);
@@ -210,7 +210,10 @@ bool CutConsumerList::IsOk() const
 void CutConsumerList::Process(uint64_t a_evid)
 {
   for (auto it = m_cut_vec.begin(); m_cut_vec.end() != it; ++it) {
-    it->node->Process(a_evid);
+    auto node = it->node;
+    if (!node->IsEvent(a_evid) || node->IsActive()) {
+      node->Process(a_evid);
+    }
   }
 }
 
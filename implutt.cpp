@@ -30,6 +30,7 @@
 #include <map>
 #include <set>
 #include <sstream>
+#include <type_traits>
 #include <ttf.hpp>
 #include <util.hpp>
 
@@ -192,7 +193,9 @@ namespace ImPlutt {
     m_level_stack(),
     m_text_tex_map(),
     m_do_close(),
-    m_tex_destroy_list()
+    m_tex_destroy_list(),
+    m_tex_state_set(),
+    m_sdl_rect_vec()
   {
     // Find a position that causes little overlap.
     // Silly approach: Move the window in large steps, choose what causes the
@@ -286,6 +289,9 @@ namespace ImPlutt {
     auto it = g_window_set.find(this);
     assert(g_window_set.end() != it);
     g_window_set.erase(it);
+    while (!m_tex_state_set.empty()) {
+      TexRelease(*m_tex_state_set.begin());
+    }
     for (auto it2 = m_text_tex_map.begin(); m_text_tex_map.end() != it2;
         ++it2) {
       SDL_DestroyTexture(it2->second.tex);
@@ -507,6 +513,25 @@ namespace ImPlutt {
     }
   }
 
+  void Window::RenderRects(std::vector<Rect> const &a_vec)
+  {
+    if (a_vec.empty()) {
+      return;
+    }
+    auto const &l = LevelGet();
+    m_sdl_rect_vec.resize(a_vec.size());
+    for (size_t i = 0; i < a_vec.size(); ++i) {
+      auto const &r = a_vec[i];
+      auto &sdl_r = m_sdl_rect_vec[i];
+      sdl_r.x = l.cursor.x + r.x;
+      sdl_r.y = l.cursor.y + r.y;
+      sdl_r.w = r.w;
+      sdl_r.h = r.h;
+    }
+    SDL_CALL_VOID(SDL_RenderFillRects, (m_renderer, m_sdl_rect_vec.data(),
+        (int)m_sdl_rect_vec.size()));
+  }
+
   void Window::RenderTexture(SDL_Texture *a_tex, Rect const &a_r)
   {
     auto &l = LevelGet();
@@ -862,6 +887,15 @@ namespace ImPlutt {
     LevelPush(r);
   }
 
+  void Window::TexRelease(PlotState *a_state)
+  {
+    auto &tex = a_state->tex;
+    assert(this == tex.window);
+    SDL_DestroyTexture(tex.tex);
+    tex = PlotState::Tex();
+    m_tex_state_set.erase(a_state);
+  }
+
   //
   // Colormaps.
   //
@@ -906,6 +940,67 @@ namespace ImPlutt {
     };
     std::vector<Colormap> g_cmap_vec;
     size_t g_cmap_i;
+
+    // Maps bin contents to packed RGBA8888 pixels for one z-mapping, with a
+    // table for small integer contents which make up most bins of sparse
+    // 2D histograms.
+#define COLOR_LUT_MAX 4096
+    class ColorLut {
+      public:
+        ColorLut(Colormap const &a_cmap, SDL_Color const &a_bg, double
+            a_min_z, double a_max_z, bool a_is_log, double a_max):
+          m_min_z(a_min_z),
+          m_dz(std::max(a_max_z - a_min_z, 1.0)),
+          m_is_log(a_is_log),
+          m_bg(Pack(a_bg.r, a_bg.g, a_bg.b)),
+          m_ramp(),
+          m_lut()
+        {
+          m_ramp.reserve(a_cmap.ramp.size());
+          for (auto it = a_cmap.ramp.begin(); a_cmap.ramp.end() != it;
+              ++it) {
+            m_ramp.push_back(Pack(it->r, it->g, it->b));
+          }
+          auto n = (size_t)std::min(a_max + 1, (double)COLOR_LUT_MAX);
+          m_lut.resize(n);
+          for (size_t i = 0; i < n; ++i) {
+            m_lut[i] = Map((double)i);
+          }
+        }
+        uint32_t Get(uint32_t a_v) const
+        {
+          return a_v < m_lut.size() ? m_lut[a_v] : Map(a_v);
+        }
+        uint32_t Get(double a_v) const
+        {
+          return Map(a_v);
+        }
+
+      private:
+        static uint32_t Pack(uint8_t a_r, uint8_t a_g, uint8_t a_b)
+        {
+          return (uint32_t)a_r << 24 | (uint32_t)a_g << 16 |
+              (uint32_t)a_b << 8 | 255;
+        }
+        uint32_t Map(double a_v) const
+        {
+          if (a_v <= 0.0) {
+            return m_bg;
+          }
+          // Same as Plot::LinOrLogFromLinZ.
+          auto z = m_is_log ? log10(std::max(a_v, 1e-1)) : a_v;
+          auto f = (z - m_min_z) / m_dz;
+          auto i = (size_t)((double)(m_ramp.size() - 1) * f);
+          return m_ramp[std::min(i, m_ramp.size() - 1)];
+        }
+
+        double m_min_z;
+        double m_dz;
+        bool m_is_log;
+        uint32_t m_bg;
+        std::vector<uint32_t> m_ramp;
+        std::vector<uint32_t> m_lut;
+    };
   }
 
   size_t ColormapGet(char const *a_name)
@@ -1252,6 +1347,18 @@ namespace ImPlutt {
   {
   }
 
+  PlotState::Tex::Tex():
+    window(),
+    tex(),
+    w(),
+    h(),
+    gen(),
+    colormap(),
+    is_log(),
+    style()
+  {
+  }
+
   PlotState::PlotState(uint32_t a_mask):
     state_mask(a_mask),
     user_state(),
@@ -1260,13 +1367,17 @@ namespace ImPlutt {
     cut(),
     proj(),
     zooming(),
-    do_clear()
+    do_clear(),
+    tex()
   {
   }
 
   PlotState::~PlotState()
   {
     Unproject();
+    if (tex.window) {
+      tex.window->TexRelease(this);
+    }
   }
 
   void PlotState::CutClear()
@@ -2062,7 +2173,8 @@ namespace ImPlutt {
     RenderColor(g_style[g_style_i][STYLE_PLOT_BG]);
     RenderRect(r, false);
 
-    // TODO: Plot texture and render that, faster?
+    // Columns are collected and rendered in one go.
+    std::vector<Rect> col_vec;
 
     RenderColor(g_style[g_style_i][STYLE_PLOT_FG]);
     // Figure out how many pixels the histogram covers.
@@ -2071,6 +2183,7 @@ namespace ImPlutt {
     auto pixels = right - left;
     if (pixels >= (int)a_bins) {
       // We have at least 1px/bin, render one rect per entry.
+      col_vec.reserve(a_bins);
       auto pos_x_prev = left;
       for (size_t i = 0; i < a_bins; ++i) {
         auto x = a_min + (a_max - a_min) * ((double)i + 1) / (double)a_bins;
@@ -2084,9 +2197,10 @@ namespace ImPlutt {
         r_col.y = h;
         r_col.w = pos_x - pos_x_prev;
         r_col.h = r.h - h;
-        RenderRect(r_col, false);
+        col_vec.push_back(r_col);
         pos_x_prev = pos_x;
       }
+      RenderRects(col_vec);
     } else {
       // Fewer pixels than bins, do nearest-neighbour boundaries and draw
       // filtered pixel-columns from vertical min to max.
@@ -2095,6 +2209,7 @@ namespace ImPlutt {
         int max;
       };
       std::vector<Blurred> blurred((size_t)r.w);
+      col_vec.reserve((size_t)r.w);
       size_t i0 = (size_t)(
           (double)a_bins * (a_plot->PointFromPosX(0) - a_min)
           / (a_max - a_min));
@@ -2124,7 +2239,7 @@ namespace ImPlutt {
         r_col.y = h_min;
         r_col.w = 1;
         r_col.h = r.h - h_min;
-        RenderRect(r_col, false);
+        col_vec.push_back(r_col);
 
         auto &b = blurred.at((size_t)pi);
         b.min = h_min;
@@ -2132,11 +2247,13 @@ namespace ImPlutt {
 
         i0 = i1;
       }
+      RenderRects(col_vec);
       // Draw blurred min-max columns.
       SDL_Color col = g_style[g_style_i][STYLE_PLOT_FG];
       col.a = 128;
       RenderColor(col);
       a_plot->m_window->RenderTransparent(true);
+      col_vec.clear();
       for (int pi = 0; pi < r.w; ++pi) {
         auto const &b = blurred.at((size_t)pi);
         Rect r_col;
@@ -2144,8 +2261,9 @@ namespace ImPlutt {
         r_col.y = b.max;
         r_col.w = 1;
         r_col.h = b.min - b.max;
-        RenderRect(r_col, false);
+        col_vec.push_back(r_col);
       }
+      RenderRects(col_vec);
     a_plot->m_window->RenderTransparent(false);
     }
   }
@@ -2160,7 +2278,7 @@ namespace ImPlutt {
   void Window::PlotHist2(Plot *a_plot, size_t a_colormap, \
       Point const &a_min, Point const &a_max, \
       std::vector<T> const &a_vec, size_t a_bins_y, size_t a_bins_x, \
-      std::vector<uint8_t> &a_pixels)
+      uint64_t a_gen)
   template <typename T> PLOT_TMPL(T)
   {
     if (!a_bins_y || !a_bins_x) {
@@ -2170,108 +2288,98 @@ namespace ImPlutt {
 
     auto const &rect = a_plot->m_rect_graph;
 
-    T min_t = a_vec[0];
-    T max_t = a_vec[0];
-    for (size_t ofs = 1; ofs < a_bins_y * a_bins_x; ++ofs) {
-      auto v = a_vec[ofs];
-      min_t = std::min(min_t, v);
-      max_t = std::max(max_t, v);
-    }
-    auto min_z = a_plot->LinOrLogFromLinZ(min_t);
-    auto max_z = a_plot->LinOrLogFromLinZ(max_t);
-    auto dz = std::max(max_z - min_z, 1.0);
-
-    auto const &cmap = g_cmap_vec.at(a_colormap);
-
-    auto const &bg_col = g_style[g_style_i][STYLE_PLOT_BG];
     size_t w, h;
+    bool is_scaled;
     if ((size_t)rect.w >= a_bins_x && (size_t)rect.h >= a_bins_y) {
+      // More pixels than bins, let SDL scale the texture.
       w = a_bins_x;
       h = a_bins_y;
-      // More pixels than bins, let SDL scale the texture.
-      auto bytes = w * h * 4;
-      if (a_pixels.size() < bytes) {
-        a_pixels.resize(bytes);
-      }
-      uint8_t *p = &a_pixels.at(0);
-      for (size_t i = 0; i < h; ++i) {
-        auto t = &a_vec.at((h - i - 1) * w);
-        for (size_t j = 0; j < w; ++j) {
-          *p++ = 255;
-          auto v = (double)*t++;
-          if (v > 0.0) {
-            v = a_plot->LinOrLogFromLinZ(v);
-            auto f = (v - min_z) / dz;
-            auto const ramp_i = (size_t)(
-                (double)(cmap.ramp.size() - 1) * f);
-            auto const &rgb = cmap.ramp.at(ramp_i);
-            *p++ = rgb.b;
-            *p++ = rgb.g;
-            *p++ = rgb.r;
-          } else {
-            *p++ = bg_col.b;
-            *p++ = bg_col.g;
-            *p++ = bg_col.r;
-          }
-        }
-      }
+      is_scaled = true;
     } else {
       // <1px/bin, do nearest-neighbour filtering.
       w = std::min((size_t)rect.w, a_bins_x);
       h = std::min((size_t)rect.h, a_bins_y);
-      auto bytes = w * h * 4;
-      if (a_pixels.size() < bytes) {
-        a_pixels.resize(bytes);
+      is_scaled = false;
+    }
+
+    // (Re-)create the texture when the pixel dimensions change, and only
+    // update the pixels when the content or the mapping changed.
+    auto &tex = a_plot->m_state->tex;
+    bool do_update = false;
+    if (this != tex.window || (int)w != tex.w || (int)h != tex.h) {
+      if (tex.window) {
+        tex.window->TexRelease(a_plot->m_state);
       }
-      uint8_t *p = &a_pixels.at(0);
-      size_t i0 = 0;
+      SDL_CALL(tex.tex, SDL_CreateTexture, (m_renderer,
+          SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING, (int)w,
+          (int)h));
+      tex.window = this;
+      tex.w = (int)w;
+      tex.h = (int)h;
+      m_tex_state_set.insert(a_plot->m_state);
+      do_update = true;
+    }
+    if (do_update ||
+        a_gen != tex.gen ||
+        a_colormap != tex.colormap ||
+        a_plot->m_is_log.z != tex.is_log ||
+        g_style_i != tex.style) {
+      tex.gen = a_gen;
+      tex.colormap = a_colormap;
+      tex.is_log = a_plot->m_is_log.z;
+      tex.style = g_style_i;
+
+      T min_t = a_vec[0];
+      T max_t = a_vec[0];
+      for (size_t ofs = 1; ofs < a_bins_y * a_bins_x; ++ofs) {
+        auto v = a_vec[ofs];
+        min_t = std::min(min_t, v);
+        max_t = std::max(max_t, v);
+      }
+      ColorLut const lut(g_cmap_vec.at(a_colormap),
+          g_style[g_style_i][STYLE_PLOT_BG],
+          a_plot->LinOrLogFromLinZ(min_t), a_plot->LinOrLogFromLinZ(max_t),
+          a_plot->m_is_log.z, std::is_integral<T>::value ? max_t : 0);
+
+      void *pixels;
+      int pitch;
+      SDL_CALL_VOID(SDL_LockTexture, (tex.tex, nullptr, &pixels, &pitch));
+      typedef typename std::conditional<std::is_integral<T>::value,
+              uint64_t, double>::type Sum;
+      T const *vec = a_vec.data();
       for (size_t y = 0; y < h; ++y) {
-        auto i1 = a_bins_y * (y + 1) / (size_t)h;
+        auto p = (uint32_t *)((uint8_t *)pixels + y * (size_t)pitch);
+        if (is_scaled) {
+          auto t = &vec[(h - y - 1) * w];
+          for (size_t x = 0; x < w; ++x) {
+            p[x] = lut.Get(t[x]);
+          }
+          continue;
+        }
+        auto i0 = a_bins_y * y / h;
+        auto i1 = a_bins_y * (y + 1) / h;
         assert(i1 <= a_bins_y);
         auto i2 = i0 == i1 ? i1 + 1 : i1;
-        size_t j0 = 0;
         for (size_t x = 0; x < w; ++x) {
-          auto j1 = a_bins_x * (x + 1) / (size_t)w;
+          auto j0 = a_bins_x * x / w;
+          auto j1 = a_bins_x * (x + 1) / w;
           assert(j1 <= a_bins_x);
           auto j2 = j0 == j1 ? j1 + 1 : j1;
-          *p++ = 255;
-          double v = 0.0;
-          unsigned n = 0;
-          auto ofs = (a_bins_y - i2) * a_bins_x + j0;
+          Sum sum = 0;
+          auto row = &vec[(a_bins_y - i2) * a_bins_x];
           for (auto i = i0; i < i2; ++i) {
             for (auto j = j0; j < j2; ++j) {
-              v += a_vec.at(ofs++);
-              ++n;
+              sum += row[j];
             }
-            ofs += a_bins_x - (j2 - j0);
+            row += a_bins_x;
           }
-          v /= n;
-          if (v > 0.0) {
-            v = a_plot->LinOrLogFromLinZ(v);
-            auto f = (v - min_z) / dz;
-            auto const ramp_i = (size_t)(
-                (double)(cmap.ramp.size() - 1) * f);
-            auto const &rgb = cmap.ramp.at(ramp_i);
-            *p++ = rgb.b;
-            *p++ = rgb.g;
-            *p++ = rgb.r;
-          } else {
-            *p++ = bg_col.b;
-            *p++ = bg_col.g;
-            *p++ = bg_col.r;
-          }
-          j0 = j1;
+          auto n = (i2 - i0) * (j2 - j0);
+          p[x] = 1 == n ? lut.Get((T)sum) : lut.Get((double)sum / (double)n);
         }
-        i0 = i1;
       }
+      SDL_UnlockTexture(tex.tex);
     }
-    SDL_Surface *surf;
-    SDL_CALL(surf, SDL_CreateRGBSurfaceWithFormatFrom,
-        (&a_pixels[0], (int)w, (int)h, 32, (int)w * 4,
-         SDL_PIXELFORMAT_RGBA8888));
-    SDL_Texture *tex;
-    SDL_CALL(tex, SDL_CreateTextureFromSurface, (m_renderer, surf));
-    SDL_FreeSurface(surf);
+
     // Scale a_min/a_max into a_plot->m_min/m_max.
     Rect r;
     r.w = (int)(
@@ -2284,8 +2392,7 @@ namespace ImPlutt {
     );
     r.x = a_plot->PosFromPointX(a_min.x);
     r.y = a_plot->PosFromPointY(a_max.y);
-    RenderTexture(tex, r);
-    m_tex_destroy_list.push_back(tex);
+    RenderTexture(tex.tex, r);
 
     auto state = a_plot->m_state;
     if (state->proj.window) {
@@ -28,6 +28,7 @@
 #include <cstdlib>
 #include <list>
 #include <map>
+#include <set>
 #include <string>
 #include <vector>
 #include <SDL.h>
@@ -159,6 +160,21 @@ namespace ImPlutt {
       Rect band_r;
     } zooming;
     bool do_clear;
+    // Streaming texture for 2D histograms, kept between frames and only
+    // updated when the content or its looks change. The window that
+    // created the texture releases it, see Window::TexRelease.
+    struct Tex {
+      Tex();
+      Window *window;
+      SDL_Texture *tex;
+      int w;
+      int h;
+      uint64_t gen;
+      size_t colormap;
+      bool is_log;
+      Style style;
+    };
+    Tex tex;
     void CutClear();
     bool GoTo(UserState);
     void Project(UserState, char const *, Point const &, Point const &);
@@ -279,13 +295,13 @@ namespace ImPlutt {
       template <typename T> void PlotHist1(Plot const *, double, double,
           std::vector<T> const &, size_t);
       template <typename T> void PlotHist2(Plot  *, size_t, Point const &,
-          Point const &, std::vector<T> const &, size_t, size_t,
-          std::vector<uint8_t> &);
+          Point const &, std::vector<T> const &, size_t, size_t, uint64_t);
       void PlotLines(Plot const *, std::vector<Point> const &);
       void PlotText(Plot const *, char const *, Point const &, TextAlign,
           bool, bool);
 
       void Render();
+      void TexRelease(PlotState *);
 
     private:
       Window(Window const &);
@@ -308,6 +324,7 @@ namespace ImPlutt {
       void RenderLine(Pos const &, Pos const &);
       void RenderLineDashed(Pos const &, Pos const &, double, double);
       void RenderRect(Rect const &, bool);
+      void RenderRects(std::vector<Rect> const &);
       void RenderTexture(SDL_Texture *, Rect const &);
       void RenderCross(Pos const &, int);
       void RenderText(char const *, TextStyle, int, Pos const &);
@@ -326,6 +343,8 @@ namespace ImPlutt {
       std::map<TextKey, TextTexture, TextKey> m_text_tex_map;
       bool m_do_close;
       std::list<SDL_Texture *> m_tex_destroy_list;
+      std::set<PlotState *> m_tex_state_set;
+      std::vector<SDL_Rect> m_sdl_rect_vec;
 
       friend class Plot;
   };
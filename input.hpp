@@ -30,12 +30,14 @@
 /*
  * Input base stuff.
  *
- * NOTE: Input fetches data from source with Fetch() and buffers in a second
- * location with Buffer(), in parallel Config processes the last buffered
- * event. A time-line could therefore look like:
+ * NOTE: Input fetches data from source with Fetch() and buffers in one of
+ * several slots with Buffer(), in parallel Config processes the last
+ * buffered event of a slot. There is one slot per event thread, and an
+ * Input must be able to deliver GetData for all slots at the same time.
+ * A time-line with one event thread could look like:
  *
  * fn = input->Fetch(), ev=n
- * bn = input->Buffer(), ev=n
+ * bn = input->Buffer(slot), ev=n
  * pn = config->Process(), ev=n
  *
  *  time  thread1  thread2
@@ -51,6 +53,18 @@
  *  10    b4
  *  11    f5        p4
  *  ...
+ *
+ * And with two event threads, ie two slots:
+ *
+ *  time  thread1  thread2  thread3
+ *  1     f1
+ *  2     b1
+ *  3     f2        p1
+ *  4     b2        p1
+ *  5     f3        p1       p2
+ *  6     b3                 p2
+ *  7     f4        p3       p2
+ *  ...
  */
 class Input {
   public:
@@ -66,12 +80,17 @@ class Input {
     };
 
     virtual ~Input() {}
-    // Copy data to read buffers.
-    virtual void Buffer() = 0;
+    // Captures the fetched event into the given slot, conversion can be left
+    // to GetData so signals nobody asks for cost nothing.
+    virtual void Buffer(unsigned) = 0;
     // Fetches data.
     virtual bool Fetch() = 0;
-    // Gets event-buffer by ID, check Config::BindSignal.
-    virtual std::pair<Scalar const *, size_t> GetData(size_t) = 0;
+    // Gets event-buffer by slot and ID, check Config::BindSignal.
+    // Only called by the thread currently processing the slot.
+    virtual std::pair<Scalar const *, size_t> GetData(unsigned, size_t) = 0;
+    // Makes a Fetch that waits for data return false, also one already
+    // waiting in another thread. Inputs which never wait can ignore it.
+    virtual void Stop() {}
 };
 
 #endif
@@ -26,17 +26,19 @@
 #include <condition_variable>
 #include <iostream>
 #include <thread>
+#include <vector>
 #include <SDL_compat.h>
 #include <SDL.h>
+#include <column_cache.hpp>
 #include <config.hpp>
 #include <implutt.hpp>
 #include <plot.hpp>
+#include <record.hpp>
 #include <root.hpp>
+#include <shm_ring.hpp>
 #include <unpacker.hpp>
 #include <util.hpp>
 
-extern Config *g_config;
-
 namespace {
 
   enum InputType {
@@ -47,19 +49,30 @@ namespace {
 #       define ROOT_ARGOPT
 #endif
 #if PLUTT_UCESB
-#       define UCESB_ARGOPT "u"
+#       define UCESB_ARGOPT "t:us:"
     INPUT_UCESB,
 #else
 #       define UCESB_ARGOPT
 #endif
+    INPUT_REPLAY,
+    INPUT_CACHE,
+    INPUT_SHM,
     INPUT_NONE
   };
 
   char const *g_arg0;
   char const *g_conf_path;
-  long g_jobs;
-  Input *g_input;
-  bool g_data_running;
+  long g_jobs = 1;
+  long g_parts = 1;
+  long g_queue_len;
+  char const *g_record_path;
+  char const *g_replay_path;
+  char const *g_cache_dir;
+  char const *g_shm_name;
+#if PLUTT_UCESB
+  char const *g_server;
+  char const *g_ts;
+#endif
 
   void help(char const *a_msg)
   {
@@ -67,8 +80,18 @@ namespace {
       std::cerr << a_msg << '\n';
     }
     std::cout << "Usage: " << g_arg0 <<
-        " -f config -j jobs input...\n";
+        " -f config -j jobs -p parts -q queue -w file -c dir [input...]\n";
+    std::cout << " -j number of event threads, default 1.\n";
+    std::cout << " -p number of ROOT readers over split entry ranges, each "
+        "with -j event threads, or of unpackers over split files, default "
+        "1.\n";
+    std::cout << " -q number of buffered events, default 4 per job.\n";
+    std::cout << " -w record bound signals to file, for replay with -b.\n";
+    std::cout << " -c columnar signal cache, read if it has all signals "
+        "of the config, otherwise missing signals are added from the input.\n";
     std::cout << "Input options:\n";
+    std::cout << " -b recorded-file\n";
+    std::cout << " -m shm-ring-name, eg /plutt, see shm_ring.hpp.\n";
 #if PLUTT_ROOT
     std::cout << " -r tree-name root-files...\n";
 #else
@@ -76,65 +99,145 @@ namespace {
 #endif
 #if PLUTT_UCESB
     std::cout << " -u unpacker args...\n";
+    std::cout << " -s host[:port] unpacker, events from a ucesb struct "
+        "server, struct layout from the local unpacker.\n";
+    std::cout << " -t ts-lo[,ts-hi] before -u, merge unpackers in timestamp "
+        "order, see -p.\n";
 #else
     std::cout << " -u ucesb not compiled in.\n";
+    std::cout << " -s ucesb not compiled in.\n";
 #endif
     exit(a_msg ? EXIT_FAILURE : EXIT_SUCCESS);
   }
 
-  uint64_t g_input_i, g_event_i;
-  std::mutex g_input_event_mutex;
-  std::condition_variable g_input_cv;
-  std::condition_variable g_event_cv;
+  // One input with its ring of slots and event threads. ROOT input can be
+  // split over entry ranges into several pipelines, see -p, which all share
+  // plots with the primary config.
+  // Events are buffered in a ring of slots, the input fills slots in order
+  // and event threads take them in the same order.
+  // input_i = # buffered events.
+  // event_take_i = # events taken by event threads.
+  // event_i = # processed events.
+  // filter_reject_n = # events rejected by the event_filter, never handed
+  // to event threads.
+  struct Pipeline {
+    Pipeline():
+      input(),
+      config_vec(),
+      filter_config(),
+      data_running(),
+      input_i(),
+      event_take_i(),
+      event_i(),
+      filter_reject_n(),
+      recorder(),
+      cache_writer(),
+      input_event_mutex(),
+      input_cv(),
+      event_cv(),
+      slot_busy_vec()
+    {
+    }
+    Input *input;
+    // One config per event thread.
+    std::vector<Config *> config_vec;
+    // Replica which runs the event_filter on the input thread, if any.
+    Config *filter_config;
+    bool data_running;
+    uint64_t input_i, event_take_i, event_i, filter_reject_n;
+    // Writes accepted events, see -w.
+    Recorder *recorder;
+    // Adds uncached signals to the cache, see -c.
+    ColumnCacheWriter *cache_writer;
+    std::mutex input_event_mutex;
+    std::condition_variable input_cv;
+    std::condition_variable event_cv;
+    // Set when buffered and not yet processed.
+    std::vector<bool> slot_busy_vec;
+    private:
+    Pipeline(Pipeline const &);
+    Pipeline &operator=(Pipeline const &);
+  };
+  std::vector<Pipeline *> g_pipeline_vec;
 
-  void main_input(int argc, char **argv)
+  void main_input(Pipeline *a_pl)
   {
     std::cout << "Starting input loop.\n";
     for (;;) {
-      // Fetch event and wait until buffered event is done.
-      if (!g_input->Fetch()) {
-        g_data_running = false;
+      // Fetch event and wait until the next slot in the ring is free.
+      if (!a_pl->input->Fetch()) {
+        if (a_pl->data_running && a_pl->cache_writer) {
+          a_pl->cache_writer->Commit();
+        }
+        a_pl->data_running = false;
       }
-      std::unique_lock<std::mutex> lock(g_input_event_mutex);
-      g_input_cv.wait(lock, []{
-          return g_input_i == g_event_i || !g_data_running;
+      std::unique_lock<std::mutex> lock(a_pl->input_event_mutex);
+      auto slot = (unsigned)(a_pl->input_i % a_pl->slot_busy_vec.size());
+      a_pl->input_cv.wait(lock, [a_pl, slot]{
+          return !a_pl->slot_busy_vec[slot] || !a_pl->data_running;
       });
-      if (!g_data_running) {
+      if (!a_pl->data_running) {
         lock.unlock();
         break;
       }
+      lock.unlock();
 
-      // Buffer fetched data and wake up the event thread.
-      g_input->Buffer();
-      ++g_input_i;
+      // The slot is ours until marked busy, buffer fetched data into it and
+      // wake up an event thread. Rejected events leave the slot free for the
+      // next one, but are still cached.
+      a_pl->input->Buffer(slot);
+      if (a_pl->cache_writer) {
+        a_pl->cache_writer->Write(a_pl->input, slot);
+      }
+      if (a_pl->filter_config &&
+          !a_pl->filter_config->DoFilter(a_pl->input, slot)) {
+        lock.lock();
+        ++a_pl->filter_reject_n;
+        lock.unlock();
+        continue;
+      }
+      if (a_pl->recorder) {
+        a_pl->recorder->Write(a_pl->input, slot);
+      }
+      lock.lock();
+      a_pl->slot_busy_vec[slot] = true;
+      ++a_pl->input_i;
       lock.unlock();
-      g_event_cv.notify_one();
+      a_pl->event_cv.notify_one();
     }
-    g_event_cv.notify_one();
+    a_pl->event_cv.notify_all();
     std::cout << "Exited input loop.\n";
   }
 
-  void main_event(int argc, char **argv)
+  void main_event(Pipeline *a_pl, unsigned a_thread_i)
   {
-    std::cout << "Starting event loop.\n";
+    std::cout << "Starting event loop " << a_thread_i << ".\n";
+    auto config = a_pl->config_vec.at(a_thread_i);
     for (;;) {
-      // Wait until there's a new buffered event.
-      std::unique_lock<std::mutex> lock(g_input_event_mutex);
-      g_event_cv.wait(lock, []{
-          return g_input_i > g_event_i || !g_data_running;
+      // Wait until there's a buffered event nobody has taken, buffered
+      // events are processed even when stopping.
+      std::unique_lock<std::mutex> lock(a_pl->input_event_mutex);
+      a_pl->event_cv.wait(lock, [a_pl]{
+          return a_pl->event_take_i < a_pl->input_i || !a_pl->data_running;
       });
-      if (!g_data_running) {
+      if (a_pl->event_take_i == a_pl->input_i) {
         lock.unlock();
         break;
       }
+      auto slot = (unsigned)(a_pl->event_take_i %
+          a_pl->slot_busy_vec.size());
+      ++a_pl->event_take_i;
+      lock.unlock();
 
-      // Process buffered event, then wake up the input thread.
-      g_config->DoEvent(g_input);
-      ++g_event_i;
+      // Process buffered event, then free the slot for the input thread.
+      config->DoEvent(a_pl->input, slot);
+      lock.lock();
+      a_pl->slot_busy_vec[slot] = false;
+      ++a_pl->event_i;
       lock.unlock();
-      g_input_cv.notify_one();
+      a_pl->input_cv.notify_one();
     }
-    std::cout << "Exited event loop.\n";
+    std::cout << "Exited event loop " << a_thread_i << ".\n";
   }
 
 }
@@ -159,7 +262,8 @@ int main(int argc, char **argv)
   // Handle arguments.
   enum InputType input_type = INPUT_NONE;
   int c;
-  while ((c = getopt(argc, argv, "hf:j:" ROOT_ARGOPT UCESB_ARGOPT)) != -1) {
+  while ((c = getopt(argc, argv, "b:c:hf:j:m:p:q:w:"
+      ROOT_ARGOPT UCESB_ARGOPT)) != -1) {
     switch (c) {
       case 'h':
         help(nullptr);
@@ -170,11 +274,43 @@ int main(int argc, char **argv)
         {
           char *end;
           g_jobs = strtol(optarg, &end, 10);
-          if ('\0' != *end) {
+          if ('\0' != *end || g_jobs < 1) {
             help("Invalid integer jobs.");
           }
         }
         break;
+      case 'p':
+        {
+          char *end;
+          g_parts = strtol(optarg, &end, 10);
+          if ('\0' != *end || g_parts < 1) {
+            help("Invalid integer parts.");
+          }
+        }
+        break;
+      case 'q':
+        {
+          char *end;
+          g_queue_len = strtol(optarg, &end, 10);
+          if ('\0' != *end || g_queue_len < 1) {
+            help("Invalid integer queue.");
+          }
+        }
+        break;
+      case 'c':
+        g_cache_dir = optarg;
+        break;
+      case 'w':
+        g_record_path = optarg;
+        break;
+      case 'b':
+        g_replay_path = optarg;
+        input_type = INPUT_REPLAY;
+        break;
+      case 'm':
+        g_shm_name = optarg;
+        input_type = INPUT_SHM;
+        break;
 #if PLUTT_ROOT
       case 'r':
         if (argc - optind < 2) {
@@ -190,49 +326,142 @@ int main(int argc, char **argv)
         }
         input_type = INPUT_UCESB;
         break;
+      case 's':
+        if (argc - optind < 1) {
+          help("Not enough parameters for -s.");
+        }
+        g_server = optarg;
+        input_type = INPUT_UCESB;
+        break;
+      case 't':
+        g_ts = optarg;
+        break;
 #endif
       default:
         help("Invalid argument.");
         break;
     }
-    if (INPUT_NONE != input_type) {
+    // -r/-u/-s take the rest of the command line, -b/-m only their optarg.
+    if (INPUT_NONE != input_type &&
+        INPUT_REPLAY != input_type &&
+        INPUT_SHM != input_type) {
       break;
     }
   }
   argc -= optind;
   argv += optind;
+  if ((INPUT_REPLAY == input_type || INPUT_SHM == input_type) && argc > 0) {
+    help("Unexpected arguments after options.");
+  }
   if (!g_conf_path) {
     help("I need a config file, see -f!");
   }
-  if (INPUT_NONE == input_type) {
+  if (INPUT_NONE == input_type && !g_cache_dir) {
     help("I need an input!");
   }
+  if (0 == g_queue_len) {
+    g_queue_len = 4 * g_jobs;
+  }
+  if (g_queue_len < g_jobs) {
+    help("Queue must be at least as long as the number of jobs.");
+  }
 
   // Config figures out requested signals and asks the input to deliver blobs
   // of arrays.
-  // The ctor sets g_config by itself, nice hack bro.
-  new Config(g_conf_path);
-  switch (input_type) {
+  auto config = new Config(g_conf_path, nullptr);
+  auto slot_num = (unsigned)g_queue_len;
+  if (g_cache_dir) {
+    if (ColumnCache::Covers(*config, g_cache_dir)) {
+      input_type = INPUT_CACHE;
+    } else if (INPUT_NONE == input_type) {
+      help("Cache misses signals and there is no input to fill it.");
+    }
+  }
+  // ROOT parts get a pipeline each, ucesb parts are merged by one input.
+  long pipeline_n = g_parts;
+#if PLUTT_UCESB
+  if (INPUT_UCESB == input_type) {
+    pipeline_n = 1;
+  }
+#endif
+  if (pipeline_n > 1 && config->HasClockMatch()) {
+    // Every part would start its own clock at its first entry.
+    help("clock_match needs one time-ordered input, cannot use -p.");
+  }
+  for (long part_i = 0; part_i < pipeline_n; ++part_i) {
+    auto pl = new Pipeline;
+    g_pipeline_vec.push_back(pl);
+    switch (input_type) {
 #if PLUTT_ROOT
-    case INPUT_ROOT:
-      g_input = new Root(*g_config, argc, argv);
-      break;
+      case INPUT_ROOT:
+        pl->input = new Root(*config, slot_num, argc, argv, (unsigned)part_i,
+            (unsigned)g_parts);
+        break;
 #endif
 #if PLUTT_UCESB
-    case INPUT_UCESB:
-      g_input = new Unpacker(*g_config, argc, argv);
-      break;
+      case INPUT_UCESB:
+        pl->input = new Unpacker(*config, slot_num, argc, argv, g_server,
+            (unsigned)g_parts, g_ts);
+        break;
 #endif
-    default:
-      throw std::runtime_error(__func__);
+      case INPUT_REPLAY:
+        if (g_parts > 1) {
+          help("Only ROOT and ucesb input can be split with -p.");
+        }
+        pl->input = new Replay(*config, slot_num, g_replay_path);
+        break;
+      case INPUT_CACHE:
+        if (g_parts > 1) {
+          help("Only ROOT and ucesb input can be split with -p.");
+        }
+        pl->input = new ColumnCache(*config, slot_num, g_cache_dir);
+        break;
+      case INPUT_SHM:
+        if (g_parts > 1) {
+          help("Only ROOT and ucesb input can be split with -p.");
+        }
+        pl->input = new ShmRing(*config, slot_num, g_shm_name);
+        break;
+      default:
+        throw std::runtime_error(__func__);
+    }
+    if (g_record_path) {
+      if (pipeline_n > 1) {
+        help("Cannot record split input, see -p.");
+      }
+      pl->recorder = new Recorder(*config, g_record_path);
+    }
+    if (g_cache_dir && INPUT_CACHE != input_type) {
+      if (pipeline_n > 1) {
+        help("Cannot cache split input, see -p.");
+      }
+      pl->cache_writer = new ColumnCacheWriter(*config, g_cache_dir);
+    }
+
+    // Every event thread runs its own node graph, replicas share plots and
+    // calibration state with the primary.
+    for (long i = 0; i < g_jobs; ++i) {
+      pl->config_vec.push_back(0 == part_i && 0 == i ? config :
+          new Config(g_conf_path, config));
+    }
+    if (config->HasEventFilter()) {
+      pl->filter_config = new Config(g_conf_path, config);
+    }
+    pl->slot_busy_vec.resize(slot_num);
   }
 
   Status_set("Started.");
 
-  // Start data thread.
-  g_data_running = true;
-  std::thread thread_input(main_input, argc, argv);
-  std::thread thread_event(main_event, argc, argv);
+  // Start data threads.
+  std::vector<std::thread> thread_vec;
+  for (auto it = g_pipeline_vec.begin(); g_pipeline_vec.end() != it; ++it) {
+    auto pl = *it;
+    pl->data_running = true;
+    thread_vec.push_back(std::thread(main_input, pl));
+    for (unsigned i = 0; i < pl->config_vec.size(); ++i) {
+      thread_vec.push_back(std::thread(main_event, pl, i));
+    }
+  }
 
   ImPlutt::Setup();
 
@@ -246,7 +475,7 @@ int main(int argc, char **argv)
   for (bool is_running = true; is_running;) {
 
     // Use event timeout to cap UI rate.
-    auto t_end = SDL_GETTICKS() + 1000 / g_config->UIRateGet();
+    auto t_end = SDL_GETTICKS() + 1000 / config->UIRateGet();
     for (;;) {
       auto t_cur = SDL_GETTICKS();
       if (t_cur > t_end) {
@@ -264,32 +493,66 @@ int main(int argc, char **argv)
     }
     Time_set_ms(t_end);
 
+    unsigned queue_n = 0;
+    uint64_t event_i1 = 0;
+    uint64_t filter_accept_n = 0;
+    uint64_t filter_reject_n = 0;
+    for (auto it = g_pipeline_vec.begin(); g_pipeline_vec.end() != it;
+        ++it) {
+      auto pl = *it;
+      const std::lock_guard<std::mutex> lock(pl->input_event_mutex);
+      queue_n += (unsigned)(pl->input_i - pl->event_i);
+      event_i1 += pl->event_i;
+      if (pl->filter_config) {
+        filter_accept_n += pl->input_i;
+        filter_reject_n += pl->filter_reject_n;
+      }
+    }
+
     ++loop_n;
 #define RATE_PER_SECOND 2
-    if (g_config->UIRateGet() / RATE_PER_SECOND == loop_n) {
-      auto event_i1 = g_event_i;
+    if (config->UIRateGet() / RATE_PER_SECOND == loop_n) {
       event_rate = (double)(event_i1 - event_i0) * RATE_PER_SECOND;
       event_i0 = event_i1;
       loop_n = 0;
     }
 
     window->Begin();
-    plot(window, event_rate);
+    plot(window, event_rate, queue_n, slot_num * (unsigned)pipeline_n,
+        filter_accept_n, filter_reject_n);
     window->End();
   }
   std::cout << "Exiting main loop...\n";
-  g_data_running = false;
-  g_input_cv.notify_one();
-  g_event_cv.notify_one();
-  thread_input.join();
-  thread_event.join();
+  for (auto it = g_pipeline_vec.begin(); g_pipeline_vec.end() != it; ++it) {
+    auto pl = *it;
+    pl->data_running = false;
+    pl->input->Stop();
+    pl->input_cv.notify_all();
+    pl->event_cv.notify_all();
+  }
+  for (auto it = thread_vec.begin(); thread_vec.end() != it; ++it) {
+    it->join();
+  }
 
   delete window;
 
   ImPlutt::Destroy();
 
-  delete g_input;
-  delete g_config;
+  // Replicas share plots owned by the primary, delete them first, the
+  // primary is the first config of the first pipeline.
+  while (!g_pipeline_vec.empty()) {
+    auto pl = g_pipeline_vec.back();
+    delete pl->cache_writer;
+    delete pl->recorder;
+    delete pl->input;
+    delete pl->filter_config;
+    while (!pl->config_vec.empty()) {
+      delete pl->config_vec.back();
+      pl->config_vec.pop_back();
+    }
+    delete pl;
+    g_pipeline_vec.pop_back();
+  }
 
   return 0;
 }
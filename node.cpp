@@ -35,24 +35,27 @@ Node::ProcessGuard::~ProcessGuard()
 
 Node::Node(std::string const &a_loc):
   m_loc(a_loc),
+  m_dep_vec(),
   m_evid(),
   m_is_active()
 {
 }
 
-std::string Node::GetLocStr() const
+void Node::DepAdd(Node *a_node)
 {
-  return m_loc;
+  if (a_node) {
+    m_dep_vec.push_back(a_node);
+  }
 }
 
-bool Node::IsActive() const
+std::vector<Node *> const &Node::GetDepVec() const
 {
-  return m_is_active;
+  return m_dep_vec;
 }
 
-bool Node::IsEvent(uint64_t a_evid) const
+std::string Node::GetLocStr() const
 {
-  return m_evid == a_evid;
+  return m_loc;
 }
 
 NodeValue::NodeValue(std::string const &a_loc):
@@ -65,7 +68,8 @@ NodeCuttable::NodeCuttable(std::string const &a_loc, std::string const
   Node(a_loc),
   m_title(a_title),
   m_cut_consumer(),
-  m_cut_producer()
+  m_cut_producer(),
+  m_cut_dep_vec()
 {
 }
 
@@ -78,6 +82,7 @@ void NodeCuttable::CutEventAdd(NodeCuttable *a_node, CutPolygon const *a_poly)
 {
   auto is_ok = a_node->m_cut_producer.AddEvent(a_poly);
   m_cut_consumer.Add(a_node, is_ok);
+  m_cut_dep_vec.push_back(a_node);
 }
 
 void NodeCuttable::CutReset()
@@ -85,6 +90,11 @@ void NodeCuttable::CutReset()
   m_cut_producer.Reset();
 }
 
+std::vector<NodeCuttable *> const &NodeCuttable::GetCutDepVec() const
+{
+  return m_cut_dep_vec;
+}
+
 std::string const &NodeCuttable::GetTitle() const
 {
   return m_title;
@@ -27,6 +27,7 @@
 #include <cassert>
 #include <iostream>
 #include <string>
+#include <vector>
 #include <cut.hpp>
 
 // Asserts something, on failure prints location in config file.
@@ -51,9 +52,13 @@
     } \
     Node::ProcessGuard node_process_guard_(this, evid)
 // Use this to process a child node, NOT the method directly!
+// Children already done this event, e.g. by the config schedule, are skipped
+// without a call, active ones still go through the guard to report loops.
 #define NODE_PROCESS(node, evid) do { \
   assert(IsActive()); \
-  node->Process(evid); \
+  if (!node->IsEvent(evid) || node->IsActive()) { \
+    node->Process(evid); \
+  } \
 } while (0)
 
 class CutPolygon;
@@ -76,15 +81,25 @@ class Node {
 
     Node(std::string const &);
     virtual ~Node() {}
+    // Nodes this node may process, for Config to schedule.
+    std::vector<Node *> const &GetDepVec() const;
     std::string GetLocStr() const;
-    bool IsActive() const;
-    bool IsEvent(uint64_t) const;
+    bool IsActive() const {
+      return m_is_active;
+    }
+    bool IsEvent(uint64_t a_evid) const {
+      return m_evid == a_evid;
+    }
     // Do NOT call this! Use the macro! Macros are good. Really. Sometimes.
     virtual void Process(uint64_t) = 0;
 
   protected:
+    // Call for every child node, null is ignored.
+    void DepAdd(Node *);
+
     std::string m_loc;
   private:
+    std::vector<Node *> m_dep_vec;
     uint64_t m_evid;
     bool m_is_active;
 };
@@ -107,6 +122,9 @@ class NodeCuttable: public Node {
     // stop processing the even.
     void CutEventAdd(NodeCuttable *, CutPolygon const *);
     void CutReset();
+    // Nodes whose cuts gate this node, the rest of the deps are only
+    // processed when all the cuts pass.
+    std::vector<NodeCuttable *> const &GetCutDepVec() const;
     std::string const &GetTitle() const;
 
   protected:
@@ -115,6 +133,9 @@ class NodeCuttable: public Node {
     CutConsumerList m_cut_consumer;
     // The list of cuts to populate by this node.
     CutProducerList m_cut_producer;
+
+  private:
+    std::vector<NodeCuttable *> m_cut_dep_vec;
 };
 
 #endif
@@ -29,6 +29,7 @@ NodeAlias::NodeAlias(std::string const &a_loc, NodeValue *a_source, uint32_t
   m_source(a_source),
   m_ret_i(a_ret_i)
 {
+  DepAdd(a_source);
 }
 
 NodeValue *NodeAlias::GetSource()
@@ -56,5 +57,6 @@ void NodeAlias::SetSource(std::string const &a_loc, NodeValue *a_source)
       throw std::runtime_error(__func__);
     }
     m_source = a_source;
+    DepAdd(a_source);
   }
 }
@@ -64,6 +64,7 @@ NodeBitfield::NodeBitfield(std::string const &a_loc, BitfieldArg *a_arg_list):
   while (n-- > 0) {
     auto next = a_arg_list->next;
     m_source_vec.at(n) = Field(a_arg_list->node, a_arg_list->bits);
+    DepAdd(a_arg_list->node);
     delete a_arg_list;
     a_arg_list = next;
   }
@@ -96,7 +97,7 @@ void NodeBitfield::Process(uint64_t a_evid)
     uint32_t min_i = UINT32_MAX;
     for (auto it = m_source_vec.begin(); m_source_vec.end() != it; ++it) {
       // Get min channel.
-      auto const &vmi = it->value->GetMI();
+      auto vmi = it->value->GetMISpan();
       if (it->i < vmi.size()) {
         auto mi = vmi[it->i];
         min_i = std::min(min_i, mi);
@@ -109,7 +110,7 @@ void NodeBitfield::Process(uint64_t a_evid)
     uint32_t ofs = 0;
     for (auto it = m_source_vec.begin(); m_source_vec.end() != it; ++it,
         ofs += it->bits) {
-      auto const &vmi = it->value->GetMI();
+      auto vmi = it->value->GetMISpan();
       if (it->i >= vmi.size()) {
         continue;
       }
@@ -117,13 +118,11 @@ void NodeBitfield::Process(uint64_t a_evid)
       if (mi != min_i) {
         continue;
       }
-      auto me = it->value->GetME()[it->i];
+      auto me = it->value->GetMESpan()[it->i];
       if (it->vi >= me) {
         continue;
       }
-      auto const &vv = it->value->GetV();
-      assert(it->vi < vv.size());
-      uint64_t part = vv[it->vi].u64;
+      uint64_t part = it->value->GetVSpan()[it->vi].u64;
       auto mask = (1ULL << it->bits) - 1;
       if (part > mask) {
         std::cerr << it->node->GetLocStr() <<
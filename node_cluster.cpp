@@ -31,6 +31,7 @@ NodeCluster::NodeCluster(std::string const &a_loc, NodeValue *a_child):
   m_e(),
   m_eta()
 {
+  DepAdd(a_child);
   m_x.SetType(Input::kDouble);
   m_e.SetType(Input::kDouble);
   m_eta.SetType(Input::kDouble);
@@ -60,9 +61,9 @@ void NodeCluster::Process(uint64_t a_evid)
   m_eta.Clear();
 
   auto const &val = m_child->GetValue();
-  auto const &miv = val.GetMI();
-  auto const &mev = val.GetME();
-  auto const &v = val.GetV();
+  auto miv = val.GetMISpan();
+  auto mev = val.GetMESpan();
+  auto v = val.GetVSpan();
   if (miv.empty()) {
     return;
   }
@@ -83,7 +84,7 @@ void NodeCluster::Process(uint64_t a_evid)
   double sum_e = 0.0;
   uint32_t v_i = 0;
   for (uint32_t i = 0; i < miv.size(); ++i) {
-    auto mi = miv.at(i);
+    auto mi = miv[i];
     if (mi_prev + 1 != mi) {
       if (sum_n > 0) {
         // Create previous cluster.
@@ -97,11 +98,11 @@ void NodeCluster::Process(uint64_t a_evid)
       sum_e = 0.0;
     }
     // Keep clusterizing.
-    auto vv = v.at(v_i).GetDouble(val.GetType());
+    auto vv = v[v_i].GetDouble(val.GetType());
     sum_xe += mi * vv;
     sum_e += vv;
     ++sum_n;
-    v_i = mev.at(i);
+    v_i = mev[i];
     mi_prev = mi;
   }
   if (sum_n > 0) {
@@ -113,6 +114,9 @@ void NodeCluster::Process(uint64_t a_evid)
   }
 
   // Move sorted set to value.
+  m_x.Reserve(1, sorted_set.size());
+  m_e.Reserve(1, sorted_set.size());
+  m_eta.Reserve(1, sorted_set.size());
   for (auto it = sorted_set.begin(); sorted_set.end() != it; ++it) {
     Input::Scalar s;
     s.dbl = it->x;
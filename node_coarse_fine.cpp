@@ -20,18 +20,28 @@
  */
 
 #include <node_coarse_fine.hpp>
+#include <algorithm>
 #include <cassert>
 #include <util.hpp>
 
+#define COARSE_FINE_SYNC_EVENTS 64
+
 NodeCoarseFine::NodeCoarseFine(std::string const &a_loc, NodeValue *a_coarse,
     NodeValue *a_fine, double a_fine_range):
   NodeValue(a_loc),
   m_coarse(a_coarse),
   m_fine(a_fine),
   m_fine_range(a_fine_range),
+  m_primary(this),
+  m_cal_mutex(),
   m_cal_fine(),
+  m_pending_vec(),
+  m_cal_local(),
+  m_event_n(),
   m_value()
 {
+  DepAdd(a_coarse);
+  DepAdd(a_fine);
 }
 
 Value const &NodeCoarseFine::GetValue(uint32_t a_ret_i)
@@ -58,22 +68,77 @@ void NodeCoarseFine::Process(uint64_t a_evid)
 
   m_value.SetType(Input::kDouble);
 
+  // The primary calibrates as it goes, under its lock.
+  std::unique_lock<std::mutex> lock(m_cal_mutex, std::defer_lock);
+  if (this == m_primary) {
+    lock.lock();
+  }
+  auto miv_c = val_c.GetMISpan();
+  auto miv_f = val_f.GetMISpan();
+  auto mev_c = val_c.GetMESpan();
+  auto mev_f = val_f.GetMESpan();
+  auto vv_c = val_c.GetVSpan();
+  auto vv_f = val_f.GetVSpan();
   uint32_t vi = 0;
-  for (uint32_t i = 0; i < val_c.GetMI().size(); ++i) {
-    auto mi = val_c.GetMI()[i];
-    NODE_ASSERT(mi, ==, val_f.GetMI()[i]);
-    auto me = val_c.GetME()[i];
-    NODE_ASSERT(me, ==, val_f.GetME()[i]);
+  for (uint32_t i = 0; i < miv_c.size(); ++i) {
+    auto mi = miv_c[i];
+    NODE_ASSERT(mi, ==, miv_f[i]);
+    auto me = mev_c[i];
+    NODE_ASSERT(me, ==, mev_f[i]);
     for (; vi < me; ++vi) {
-      auto c = (uint32_t)val_c.GetV().at(vi).u64;
-      auto f = (uint32_t)val_f.GetV().at(vi).u64;
-      if (mi >= m_cal_fine.size()) {
-        m_cal_fine.resize(mi + 1);
+      auto c = (uint32_t)vv_c[vi].u64;
+      auto f = (uint32_t)vv_f[vi].u64;
+      double ft;
+      if (this == m_primary) {
+        if (mi >= m_cal_fine.size()) {
+          m_cal_fine.resize(mi + 1);
+        }
+        ft = m_cal_fine[mi].Get(f);
+      } else {
+        if (mi >= m_cal_local.size()) {
+          m_cal_local.resize(mi + 1);
+        }
+        if (0x3ff != f) {
+          m_pending_vec.push_back(std::make_pair(mi, f));
+        }
+        ft = m_cal_local[mi].Lookup(f);
       }
-      double ft = m_cal_fine.at(mi).Get(f);
       Input::Scalar time;
       time.dbl = m_fine_range * ((c + 1) - ft);
       m_value.Push(mi, time);
     }
   }
+
+  if (this == m_primary) {
+    return;
+  }
+  // Sync every event while warming up.
+  ++m_event_n;
+  if (m_event_n <= COARSE_FINE_SYNC_EVENTS ||
+      0 == m_event_n % COARSE_FINE_SYNC_EVENTS) {
+    Sync();
+  }
+}
+
+void NodeCoarseFine::SetPrimary(NodeCoarseFine *a_primary)
+{
+  m_primary = a_primary;
+}
+
+void NodeCoarseFine::Sync()
+{
+  auto &primary = *m_primary;
+  const std::lock_guard<std::mutex> lock(primary.m_cal_mutex);
+  auto &cal_fine = primary.m_cal_fine;
+  for (auto it = m_pending_vec.begin(); m_pending_vec.end() != it; ++it) {
+    if (it->first >= cal_fine.size()) {
+      cal_fine.resize(it->first + 1);
+    }
+    cal_fine[it->first].Add(it->second);
+  }
+  m_pending_vec.clear();
+  m_cal_local.resize(std::max(m_cal_local.size(), cal_fine.size()));
+  for (size_t mi = 0; mi < cal_fine.size(); ++mi) {
+    m_cal_local[mi].CopyCalib(cal_fine[mi]);
+  }
 }
@@ -22,27 +22,42 @@
 #ifndef NODE_COARSE_FINE_HPP
 #define NODE_COARSE_FINE_HPP
 
+#include <mutex>
 #include <cal.hpp>
 #include <node.hpp>
 #include <value.hpp>
 
 /*
  * On-the-fly fine-time calibration merged with coarse times.
+ * The calibration lives in the primary node, which calibrates and converts
+ * under its lock hit by hit. Replicas keep the fine-times and convert with a
+ * local copy of the calibration, both are synced with the primary under its
+ * lock every COARSE_FINE_SYNC_EVENTS events, and every event for the first
+ * as many events.
  */
 class NodeCoarseFine: public NodeValue {
   public:
     NodeCoarseFine(std::string const &, NodeValue *, NodeValue *, double);
     Value const &GetValue(uint32_t);
     void Process(uint64_t);
+    void SetPrimary(NodeCoarseFine *);
 
   private:
     NodeCoarseFine(NodeCoarseFine const &);
     NodeCoarseFine &operator=(NodeCoarseFine const &);
+    void Sync();
 
     NodeValue *m_coarse;
     NodeValue *m_fine;
     double m_fine_range;
+    NodeCoarseFine *m_primary;
+    std::mutex m_cal_mutex;
     std::vector<CalFineTime> m_cal_fine;
+    // Replicas: channel and fine-time of hits to calibrate with, and per
+    // channel the calibration as of the last sync.
+    std::vector<std::pair<uint32_t, uint32_t>> m_pending_vec;
+    std::vector<CalFineTime> m_cal_local;
+    uint64_t m_event_n;
     Value m_value;
 };
 
@@ -60,5 +60,6 @@ void NodeCut::Process(uint64_t a_evid)
 void NodeCut::SetCuttable(NodeCuttable *a_node)
 {
   m_cuttable = a_node;
+  DepAdd(m_cuttable);
   m_value = m_cuttable->CutDataAdd(m_cut_poly);
 }
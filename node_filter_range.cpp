@@ -28,9 +28,14 @@ NodeFilterRange::NodeFilterRange(std::string const &a_loc, CondVec const
     &a_cond_vec, std::vector<NodeValue *> const &a_src_vec):
   NodeValue(a_loc),
   m_cond_vec(a_cond_vec),
-  m_arg_vec()
+  m_arg_vec(),
+  m_ok_vec()
 {
+  for (auto it = a_cond_vec.begin(); a_cond_vec.end() != it; ++it) {
+    DepAdd(it->node);
+  }
   for (auto it = a_src_vec.begin(); a_src_vec.end() != it; ++it) {
+    DepAdd(*it);
     m_arg_vec.push_back(Arg());
     auto &a = m_arg_vec.back();
     a.node = *it;
@@ -58,38 +63,70 @@ void NodeFilterRange::Process(uint64_t a_evid)
     it->value->SetType(val.GetType());
   }
 
+  // Every condition clears the flags of its values outside the range, then
+  // the args of the surviving values are copied.
   auto const &val0 = m_cond_vec.begin()->node->GetValue();
-  auto const &miv0 = val0.GetMI();
-  auto const &mev0 = val0.GetME();
+  auto miv0 = val0.GetMISpan();
+  auto mev0 = val0.GetMESpan();
+  m_ok_vec.assign(mev0.empty() ? 0 : mev0.back(), 1);
+  for (auto it = m_cond_vec.begin(); m_cond_vec.end() != it; ++it) {
+    auto const &val = it->node->GetValue();
+    switch (val.GetType()) {
+      case Input::kNone:
+        NODE_ASSERT(miv0.size(), ==, 0U);
+        break;
+      case Input::kUint64:
+        Cond<uint64_t>(*it, val, miv0, mev0);
+        break;
+      case Input::kDouble:
+        Cond<double>(*it, val, miv0, mev0);
+        break;
+      default:
+        throw std::runtime_error(__func__);
+    }
+  }
+
   uint32_t vi = 0;
   for (uint32_t i = 0; i < miv0.size(); ++i) {
     auto mi0 = miv0[i];
     auto me0 = mev0[i];
     for (; vi < me0; ++vi) {
-      bool ok = true;
-      for (auto it = m_cond_vec.begin(); m_cond_vec.end() != it; ++it) {
-        auto const &val = it->node->GetValue();
-        auto const &miv = val.GetMI();
-        auto const &mev = val.GetME();
-        auto mi = miv.at(i);
-        auto me = mev.at(i);
-        NODE_ASSERT(mi, ==, mi0);
-        NODE_ASSERT(me, ==, me0);
-        // TODO: This double conversion should work the same for the values
-        // and the limits, but should maybe do this properly?
-        auto dbl = val.GetV(vi, false);
-        ok &= it->lower_le ? it->lower <= dbl : it->lower < dbl;
-        ok &= it->upper_le ? dbl <= it->upper : dbl < it->upper;
-      }
-      if (ok) {
+      if (m_ok_vec[vi]) {
         for (auto it = m_arg_vec.begin(); m_arg_vec.end() != it; ++it) {
           auto const &val = it->node->GetValue();
-          auto mi = val.GetMI().at(i);
+          auto mi = val.GetMISpan()[i];
           NODE_ASSERT(mi, ==, mi0);
-          auto const &s = val.GetV().at(vi);
+          auto const &s = val.GetVSpan()[vi];
           it->value->Push(mi, s);
         }
       }
     }
   }
 }
+
+template <typename T> void NodeFilterRange::Cond(FilterRangeCond const
+    &a_cond, Value const &a_val, Span<uint32_t> const &a_miv0,
+    Span<uint32_t> const &a_mev0)
+{
+  auto miv = a_val.GetMISpan();
+  auto mev = a_val.GetMESpan();
+  auto vv = a_val.GetVSpan();
+  for (uint32_t i = 0; i < a_miv0.size(); ++i) {
+    NODE_ASSERT(miv[i], ==, a_miv0[i]);
+    NODE_ASSERT(mev[i], ==, a_mev0[i]);
+  }
+  // TODO: This double conversion should work the same for the values
+  // and the limits, but should maybe do this properly?
+  // The le flags are loop invariant, so the compiler can unswitch them.
+  auto lower = a_cond.lower;
+  auto upper = a_cond.upper;
+  bool lower_le = a_cond.lower_le;
+  bool upper_le = a_cond.upper_le;
+  auto ok = m_ok_vec.data();
+  auto n = m_ok_vec.size();
+  for (size_t vi = 0; vi < n; ++vi) {
+    auto dbl = ValueToDouble<T, false>::Get(vv[vi]);
+    ok[vi] &= (lower_le ? lower <= dbl : lower < dbl) &&
+        (upper_le ? dbl <= upper : dbl < upper);
+  }
+}
@@ -54,9 +54,12 @@ class NodeFilterRange: public NodeValue {
 
     NodeFilterRange(NodeFilterRange const &);
     NodeFilterRange &operator=(NodeFilterRange const &);
+    template <typename T> void Cond(FilterRangeCond const &, Value const &,
+        Span<uint32_t> const &, Span<uint32_t> const &);
 
     CondVec m_cond_vec;
     std::vector<Arg> m_arg_vec;
+    std::vector<uint8_t> m_ok_vec;
 };
 
 #endif
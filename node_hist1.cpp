@@ -26,13 +26,23 @@
 
 NodeHist1::NodeHist1(std::string const &a_loc, char const *a_title, NodeValue
     *a_x, uint32_t a_xb, LinearTransform const &a_transform, char const
-    *a_fit, bool a_log_y, double a_drop_old_s):
+    *a_fit, bool a_log_y, double a_drop_old_s, NodeHist1 *a_primary):
   NodeCuttable(a_loc, a_title),
   m_x(a_x),
   m_xb(a_xb),
-  m_plot_hist(plot_page_add(), a_title, m_xb, a_transform, a_fit, a_log_y,
-      a_drop_old_s)
+  m_is_plot_owner(!a_primary),
+  m_plot_hist(a_primary ? a_primary->m_plot_hist :
+      new PlotHist(plot_page_add(), a_title, m_xb, a_transform, a_fit,
+        a_log_y, a_drop_old_s))
 {
+  DepAdd(a_x);
+}
+
+NodeHist1::~NodeHist1()
+{
+  if (m_is_plot_owner) {
+    delete m_plot_hist;
+  }
 }
 
 void NodeHist1::Process(uint64_t a_evid)
@@ -45,18 +55,11 @@ void NodeHist1::Process(uint64_t a_evid)
   NODE_PROCESS(m_x, a_evid);
 
   auto const &val_x = m_x->GetValue();
-  auto const &v = val_x.GetV();
+  auto v = val_x.GetVSpan();
 
-  // Pre-fill.
   for (uint32_t i = 0; i < v.size(); ++i) {
-    auto const &x = v.at(i);
+    auto const &x = v[i];
     m_cut_producer.Test(val_x.GetType(), x);
-    m_plot_hist.Prefill(val_x.GetType(), x);
-  }
-  m_plot_hist.Fit();
-  // Fill.
-  for (uint32_t i = 0; i < v.size(); ++i) {
-    auto const &x = v.at(i);
-    m_plot_hist.Fill(val_x.GetType(), x);
   }
+  m_plot_hist->Fill(val_x.GetType(), v.begin(), v.size());
 }
@@ -28,11 +28,13 @@
 
 /*
  * Collects in a 1D histogram, actual histogramming is performed in plot.*.
+ * Nodes in replica configs are given the primary node and fill its plot.
  */
 class NodeHist1: public NodeCuttable {
   public:
     NodeHist1(std::string const &, char const *, NodeValue *, uint32_t,
-        LinearTransform const &, char const *, bool, double);
+        LinearTransform const &, char const *, bool, double, NodeHist1 *);
+    ~NodeHist1();
     void Process(uint64_t);
 
   private:
@@ -41,7 +43,8 @@ class NodeHist1: public NodeCuttable {
 
     NodeValue *m_x;
     uint32_t m_xb;
-    PlotHist m_plot_hist;
+    bool m_is_plot_owner;
+    PlotHist *m_plot_hist;
 };
 
 #endif
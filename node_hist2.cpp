@@ -25,15 +25,28 @@
 NodeHist2::NodeHist2(std::string const &a_loc, char const *a_title, size_t
     a_colormap, NodeValue *a_y, NodeValue *a_x, uint32_t a_yb, uint32_t a_xb,
     LinearTransform const &a_transformy, LinearTransform const &a_transformx,
-    char const *a_fit, bool a_log_z, double a_drop_old_s):
+    char const *a_fit, bool a_log_z, double a_drop_old_s, NodeHist2
+    *a_primary):
   NodeCuttable(a_loc, a_title),
   m_x(a_x),
   m_y(a_y),
   m_xb(a_xb),
   m_yb(a_yb),
-  m_plot_hist2(plot_page_add(), a_title, a_colormap, m_yb, m_xb, a_transformy,
-      a_transformx, a_fit, a_log_z, a_drop_old_s)
+  m_is_plot_owner(!a_primary),
+  m_plot_hist2(a_primary ? a_primary->m_plot_hist2 :
+      new PlotHist2(plot_page_add(), a_title, a_colormap, m_yb, m_xb,
+        a_transformy, a_transformx, a_fit, a_log_z, a_drop_old_s)),
+  m_x_buf()
 {
+  DepAdd(a_y);
+  DepAdd(a_x);
+}
+
+NodeHist2::~NodeHist2()
+{
+  if (m_is_plot_owner) {
+    delete m_plot_hist2;
+  }
 }
 
 void NodeHist2::Process(uint64_t a_evid)
@@ -46,57 +59,42 @@ void NodeHist2::Process(uint64_t a_evid)
   NODE_PROCESS(m_y, a_evid);
 
   auto const &val_y = m_y->GetValue();
-  auto const &vec_y = val_y.GetV();
+  auto vec_y = val_y.GetVSpan();
 
   if (!m_x) {
     // Plot y.v vs y.I.
-    auto const &vmi = val_y.GetMI();
-    auto const &vme = val_y.GetME();
-    // Pre-fill.
+    auto vmi = val_y.GetMISpan();
+    auto vme = val_y.GetMESpan();
+    // Expand the index to one x per y.
+    m_x_buf.resize(vec_y.size());
+    auto x_buf = m_x_buf.begin();
     uint32_t vi = 0;
     for (uint32_t i = 0; i < vmi.size(); ++i) {
       Input::Scalar x;
       x.u64 = vmi[i];
       auto me = vme[i];
       for (; vi < me; ++vi) {
-        Input::Scalar const &y = vec_y.at(vi);
+        Input::Scalar const &y = vec_y[vi];
         m_cut_producer.Test(Input::kUint64, x, val_y.GetType(), y);
-        m_plot_hist2.Prefill(val_y.GetType(), y, Input::kUint64, x);
-      }
-    }
-    m_plot_hist2.Fit();
-    // Fill.
-    vi = 0;
-    for (uint32_t i = 0; i < vmi.size(); ++i) {
-      Input::Scalar x;
-      x.u64 = vmi[i];
-      auto me = vme[i];
-      for (; vi < me; ++vi) {
-        Input::Scalar const &y = vec_y.at(vi);
-        m_plot_hist2.Fill(val_y.GetType(), y, Input::kUint64, x);
+        x_buf[vi] = x;
       }
     }
+    m_plot_hist2->Fill(val_y.GetType(), vec_y.begin(), Input::kUint64,
+        m_x_buf.begin(), vi);
   } else {
     // Plot y.v vs x.v until either is exhausted.
     NODE_PROCESS(m_x, a_evid);
     auto const &val_x = m_x->GetValue();
-    auto const &vec_x = val_x.GetV();
+    auto vec_x = val_x.GetVSpan();
 
     auto size = std::min(vec_x.size(), vec_y.size());
 
-    // Pre-fill.
     for (uint32_t i = 0; i < size; ++i) {
-      auto const &x = vec_x.at(i);
-      auto const &y = vec_y.at(i);
+      auto const &x = vec_x[i];
+      auto const &y = vec_y[i];
       m_cut_producer.Test(val_x.GetType(), x, val_y.GetType(), y);
-      m_plot_hist2.Prefill(val_y.GetType(), y, val_x.GetType(), x);
-    }
-    m_plot_hist2.Fit();
-    // Fill.
-    for (uint32_t i = 0; i < size; ++i) {
-      auto const &x = vec_x.at(i);
-      auto const &y = vec_y.at(i);
-      m_plot_hist2.Fill(val_y.GetType(), y, val_x.GetType(), x);
     }
+    m_plot_hist2->Fill(val_y.GetType(), vec_y.begin(), val_x.GetType(),
+        vec_x.begin(), size);
   }
 }
@@ -26,16 +26,19 @@
 #include <node.hpp>
 #include <plot.hpp>
 #include <util.hpp>
+#include <vector.hpp>
 
 /*
  * Collects a vs b in a 2D histogram, actual histogramming is performed in
  * plot.*.
+ * Nodes in replica configs are given the primary node and fill its plot.
  */
 class NodeHist2: public NodeCuttable {
   public:
     NodeHist2(std::string const &, char const *, size_t, NodeValue *,
         NodeValue *, uint32_t, uint32_t, LinearTransform const &,
-        LinearTransform const &, char const *, bool, double);
+        LinearTransform const &, char const *, bool, double, NodeHist2 *);
+    ~NodeHist2();
     void CutConsumerAdd(NodeCuttable *, CutProducerList *);
     void CutProducerAdd(CutPolygon *);
     void Process(uint64_t);
@@ -48,7 +51,10 @@ class NodeHist2: public NodeCuttable {
     NodeValue *m_y;
     uint32_t m_xb;
     uint32_t m_yb;
-    PlotHist2 m_plot_hist2;
+    bool m_is_plot_owner;
+    PlotHist2 *m_plot_hist2;
+    // x-values when plotting against the index.
+    Vector<Input::Scalar> m_x_buf;
 };
 
 #endif
@@ -28,6 +28,7 @@ NodeLength::NodeLength(std::string const &a_loc, NodeValue *a_child):
   m_value(),
   m_child(a_child)
 {
+  DepAdd(a_child);
 }
 
 Value const &NodeLength::GetValue(uint32_t a_ret_i)
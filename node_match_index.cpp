@@ -30,6 +30,8 @@ NodeMatchIndex::NodeMatchIndex(std::string const &a_loc, NodeValue *a_l,
   m_val_l(),
   m_val_r()
 {
+  DepAdd(a_l);
+  DepAdd(a_r);
 }
 
 Value const &NodeMatchIndex::GetValue(uint32_t a_ret_i)
@@ -57,22 +59,31 @@ void NodeMatchIndex::Process(uint64_t a_evid)
   auto const &val_r = m_node_r->GetValue();
   m_val_l.SetType(val_l.GetType());
   m_val_r.SetType(val_r.GetType());
+  // At most everything matches.
+  m_val_l.Reserve(val_l.GetMI().size(), val_l.GetV().size());
+  m_val_r.Reserve(val_r.GetMI().size(), val_r.GetV().size());
 
+  auto miv_l = val_l.GetMISpan();
+  auto mev_l = val_l.GetMESpan();
+  auto miv_r = val_r.GetMISpan();
+  auto mev_r = val_r.GetMESpan();
+  auto vv_l = val_l.GetVSpan();
+  auto vv_r = val_r.GetVSpan();
   uint32_t i_l = 0;
   uint32_t i_r = 0;
-  while (i_l < val_l.GetMI().size() && i_r < val_r.GetMI().size()) {
-    auto mi_l = val_l.GetMI()[i_l];
-    auto mi_r = val_r.GetMI()[i_r];
+  while (i_l < miv_l.size() && i_r < miv_r.size()) {
+    auto mi_l = miv_l[i_l];
+    auto mi_r = miv_r[i_r];
     if (mi_l < mi_r) {
       ++i_l;
     } else if (mi_l > mi_r) {
       ++i_r;
     } else {
 #define MATCH_INDEX_PUSH(sub) do {\
-      auto me_0 = 0 == i_##sub ? 0 : val_##sub.GetME().at(i_##sub - 1);\
-      auto me_1 = val_##sub.GetME().at(i_##sub);\
+      auto me_0 = 0 == i_##sub ? 0 : mev_##sub[i_##sub - 1];\
+      auto me_1 = mev_##sub[i_##sub];\
       for (; me_0 < me_1; ++me_0) {\
-        m_val_##sub.Push(mi_##sub, val_##sub.GetV()[me_0]);\
+        m_val_##sub.Push(mi_##sub, vv_##sub[me_0]);\
       }\
     } while (0)
       MATCH_INDEX_PUSH(l);
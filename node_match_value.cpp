@@ -31,6 +31,8 @@ NodeMatchValue::NodeMatchValue(std::string const &a_loc, NodeValue *a_l,
   m_val_l(),
   m_val_r()
 {
+  DepAdd(a_l);
+  DepAdd(a_r);
 }
 
 Value const &NodeMatchValue::GetValue(uint32_t a_ret_i)
@@ -59,26 +61,32 @@ void NodeMatchValue::Process(uint64_t a_evid)
   m_val_l.SetType(val_l.GetType());
   m_val_r.SetType(val_r.GetType());
 
+  auto miv_l = val_l.GetMISpan();
+  auto mev_l = val_l.GetMESpan();
+  auto miv_r = val_r.GetMISpan();
+  auto mev_r = val_r.GetMESpan();
+  auto vv_l = val_l.GetVSpan();
+  auto vv_r = val_r.GetVSpan();
   uint32_t i_l = 0;
   uint32_t i_r = 0;
-  while (i_l < val_l.GetMI().size() && i_r < val_r.GetMI().size()) {
-    auto mi_l = val_l.GetMI()[i_l];
-    auto mi_r = val_r.GetMI()[i_r];
+  while (i_l < miv_l.size() && i_r < miv_r.size()) {
+    auto mi_l = miv_l[i_l];
+    auto mi_r = miv_r[i_r];
     if (mi_l < mi_r) {
       ++i_l;
     } else if (mi_l > mi_r) {
       ++i_r;
     } else {
 
-      auto me_l0 = 0 == i_l ? 0 : val_l.GetME().at(i_l - 1);
-      auto me_l1 = val_l.GetME().at(i_l);
+      auto me_l0 = 0 == i_l ? 0 : mev_l[i_l - 1];
+      auto me_l1 = mev_l[i_l];
 
-      auto me_r0 = 0 == i_r ? 0 : val_r.GetME().at(i_r - 1);
-      auto me_r1 = val_r.GetME().at(i_r);
+      auto me_r0 = 0 == i_r ? 0 : mev_r[i_r - 1];
+      auto me_r1 = mev_r[i_r];
 
       while (me_l0 < me_l1 && me_r0 < me_r1) {
-        auto v_l = val_l.GetV()[me_l0];
-        auto v_r = val_r.GetV()[me_r0];
+        auto v_l = vv_l[me_l0];
+        auto v_r = vv_r[me_r0];
 
         auto d = std::abs(v_r.dbl - v_l.dbl);
         if (d < m_cutoff) {
@@ -96,8 +104,8 @@ void NodeMatchValue::Process(uint64_t a_evid)
             // Let's assume values come in sorted order, but we don't know the
             // direction! (Eg. vftx2 and tamex3 are opposite.) So, peek at the
             // next value and see which gets closer.
-            auto vn_l = val_l.GetV()[me_l0 + 1];
-            auto vn_r = val_r.GetV()[me_r0 + 1];
+            auto vn_l = vv_l[me_l0 + 1];
+            auto vn_r = vv_r[me_r0 + 1];
             auto dl = std::abs(vn_l.dbl - v_r.dbl);
             auto dr = std::abs(vn_r.dbl - v_l.dbl);
             if (dl < dr) {
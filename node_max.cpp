@@ -28,6 +28,7 @@ NodeMax::NodeMax(std::string const &a_loc, NodeValue *a_child):
   m_child(a_child),
   m_value()
 {
+  DepAdd(a_child);
 }
 
 Value const &NodeMax::GetValue(uint32_t a_ret_i)
@@ -46,14 +47,17 @@ void NodeMax::Process(uint64_t a_evid)
   auto const &val = m_child->GetValue();
   m_value.SetType(val.GetType());
 
+  auto miv = val.GetMISpan();
+  auto mev = val.GetMESpan();
+  auto vv = val.GetVSpan();
   int max_i = -1;
   Input::Scalar max;
   uint32_t v_i = 0;
-  for (uint32_t i = 0; i < val.GetMI().size(); ++i) {
-    auto mi = val.GetMI()[i];
-    auto me = val.GetME()[i];
+  for (uint32_t i = 0; i < miv.size(); ++i) {
+    auto mi = miv[i];
+    auto me = mev[i];
     for (; v_i < me; ++v_i) {
-      auto const &v = val.GetV()[v_i];
+      auto const &v = vv[v_i];
       if (-1 == max_i || val.Cmp(v, max) > 0) {
         max_i = (int)mi;
         max = v;
@@ -30,6 +30,8 @@ NodeMeanArith::NodeMeanArith(std::string const &a_loc, NodeValue *a_l,
   m_r(a_r),
   m_value()
 {
+  DepAdd(a_l);
+  DepAdd(a_r);
 }
 
 Value const &NodeMeanArith::GetValue(uint32_t a_ret_i)
@@ -47,6 +49,8 @@ void NodeMeanArith::Process(uint64_t a_evid)
   m_value.SetType(Input::kDouble);
 
   auto const &val_l = m_l->GetValue();
+  auto miv_l = val_l.GetMISpan();
+  auto mev_l = val_l.GetMESpan();
 
   if (!m_r) {
     // Arith-mean over all "I" of n:th entry in "v".
@@ -54,8 +58,8 @@ void NodeMeanArith::Process(uint64_t a_evid)
       double sum = 0.0;
       uint32_t num = 0;
       uint32_t me_0 = 0;
-      for (uint32_t i = 0; i < val_l.GetMI().size(); ++i) {
-        auto me_1 = val_l.GetME()[i];
+      for (uint32_t i = 0; i < miv_l.size(); ++i) {
+        auto me_1 = mev_l[i];
         auto vi = me_0 + dvi;
         if (vi < me_1) {
           sum += val_l.GetV(vi, false);
@@ -74,15 +78,17 @@ void NodeMeanArith::Process(uint64_t a_evid)
     // Arith-mean between two signals for each "I".
     NODE_PROCESS(m_r, a_evid);
     auto const &val_r = m_r->GetValue();
-    NODE_ASSERT(val_l.GetMI().size(), ==, val_r.GetMI().size());
+    auto miv_r = val_r.GetMISpan();
+    auto mev_r = val_r.GetMESpan();
+    NODE_ASSERT(miv_l.size(), ==, miv_r.size());
 
     uint32_t me0_l = 0;
     uint32_t me0_r = 0;
-    for (uint32_t i = 0; i < val_l.GetMI().size(); ++i) {
-      auto mi = val_l.GetMI()[i];
-      NODE_ASSERT(mi, ==, val_r.GetMI()[i]);
-      auto me1_l = val_l.GetME()[i];
-      auto me1_r = val_r.GetME()[i];
+    for (uint32_t i = 0; i < miv_l.size(); ++i) {
+      auto mi = miv_l[i];
+      NODE_ASSERT(mi, ==, miv_r[i]);
+      auto me1_l = mev_l[i];
+      auto me1_r = mev_r[i];
       while (me0_l < me1_l && me0_r < me1_r) {
         Input::Scalar mean;
         double sum = 0.0;
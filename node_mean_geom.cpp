@@ -31,6 +31,8 @@ NodeMeanGeom::NodeMeanGeom(std::string const &a_loc, NodeValue *a_l, NodeValue
   m_r(a_r),
   m_value()
 {
+  DepAdd(a_l);
+  DepAdd(a_r);
 }
 
 Value const &NodeMeanGeom::GetValue(uint32_t a_ret_i)
@@ -48,58 +50,101 @@ void NodeMeanGeom::Process(uint64_t a_evid)
   m_value.SetType(Input::kDouble);
 
   auto const &val_l = m_l->GetValue();
+  auto type_l = val_l.GetType();
 
   if (!m_r) {
-    // Arith-mean over all "I" of n:th entry in "v".
-    for (uint32_t vi = 0;; ++vi) {
-      double sum = 0.0;
-      uint32_t num = 0;
-      uint32_t me_0 = 0;
-      for (uint32_t i = 0; i < val_l.GetMI().size(); ++i) {
-        auto me_1 = val_l.GetME()[i];
-        if (me_0 + vi < me_1) {
-          sum += val_l.GetV(me_0 + vi, false);
-          ++num;
-        }
-        me_0 = me_1;
-      }
-      if (!num) {
-        break;
-      }
-      Input::Scalar mean;
-      mean.dbl = pow(sum, 1.0 / num);
-      m_value.Push(0, mean);
+    if (Input::kUint64 == type_l) {
+      MeanOne<uint64_t>(val_l);
+    } else if (Input::kDouble == type_l) {
+      MeanOne<double>(val_l);
     }
   } else {
-    // Arith-mean between two signals for each "I".
     NODE_PROCESS(m_r, a_evid);
     auto const &val_r = m_r->GetValue();
-    NODE_ASSERT(val_l.GetMI().size(), ==, val_r.GetMI().size());
+    auto type_r = val_r.GetType();
+    if (Input::kNone == type_l || Input::kNone == type_r) {
+      NODE_ASSERT(val_l.GetMI().size(), ==, val_r.GetMI().size());
+      return;
+    }
+    // Resolve both types once, the kernels are then free of switches.
+    if (Input::kUint64 == type_l) {
+      if (Input::kUint64 == type_r) {
+        MeanTwo<uint64_t, uint64_t>(val_l, val_r);
+      } else {
+        MeanTwo<uint64_t, double>(val_l, val_r);
+      }
+    } else {
+      if (Input::kUint64 == type_r) {
+        MeanTwo<double, uint64_t>(val_l, val_r);
+      } else {
+        MeanTwo<double, double>(val_l, val_r);
+      }
+    }
+  }
+}
+
+template <typename T> void NodeMeanGeom::MeanOne(Value const &a_val)
+{
+  // Arith-mean over all "I" of n:th entry in "v".
+  auto miv = a_val.GetMISpan();
+  auto mev = a_val.GetMESpan();
+  auto vv = a_val.GetVSpan();
+  for (uint32_t vi = 0;; ++vi) {
+    double sum = 0.0;
+    uint32_t num = 0;
+    uint32_t me_0 = 0;
+    for (uint32_t i = 0; i < miv.size(); ++i) {
+      auto me_1 = mev[i];
+      if (me_0 + vi < me_1) {
+        sum += ValueToDouble<T, false>::Get(vv[me_0 + vi]);
+        ++num;
+      }
+      me_0 = me_1;
+    }
+    if (!num) {
+      break;
+    }
+    Input::Scalar mean;
+    mean.dbl = pow(sum, 1.0 / num);
+    m_value.Push(0, mean);
+  }
+}
+
+template <typename TL, typename TR> void NodeMeanGeom::MeanTwo(Value const
+    &a_val_l, Value const &a_val_r)
+{
+  // Arith-mean between two signals for each "I".
+  auto miv_l = a_val_l.GetMISpan();
+  auto mev_l = a_val_l.GetMESpan();
+  auto vv_l = a_val_l.GetVSpan();
+  auto miv_r = a_val_r.GetMISpan();
+  auto mev_r = a_val_r.GetMESpan();
+  auto vv_r = a_val_r.GetVSpan();
+  NODE_ASSERT(miv_l.size(), ==, miv_r.size());
 
-    uint32_t me0_l = 0;
-    uint32_t me0_r = 0;
-    for (uint32_t i = 0; i < val_l.GetMI().size(); ++i) {
-      auto mi = val_l.GetMI()[i];
-      NODE_ASSERT(mi, ==, val_r.GetMI()[i]);
-      auto me1_l = val_l.GetME()[i];
-      auto me1_r = val_r.GetME()[i];
-      while (me0_l < me1_l && me0_r < me1_r) {
-        Input::Scalar mean;
-        double prod = 1.0;
-        double num = 0;
-        if (me0_l < me1_l) {
-          prod *= val_l.GetV(me0_l++, true);
-          ++num;
-        }
-        if (me0_r < me1_r) {
-          prod *= val_r.GetV(me0_r++, true);
-          ++num;
-        }
-        mean.dbl = pow(prod, 1 / num);
-        m_value.Push(mi, mean);
+  uint32_t me0_l = 0;
+  uint32_t me0_r = 0;
+  for (uint32_t i = 0; i < miv_l.size(); ++i) {
+    auto mi = miv_l[i];
+    NODE_ASSERT(mi, ==, miv_r[i]);
+    auto me1_l = mev_l[i];
+    auto me1_r = mev_r[i];
+    while (me0_l < me1_l && me0_r < me1_r) {
+      Input::Scalar mean;
+      double prod = 1.0;
+      double num = 0;
+      if (me0_l < me1_l) {
+        prod *= ValueToDouble<TL, true>::Get(vv_l[me0_l++]);
+        ++num;
+      }
+      if (me0_r < me1_r) {
+        prod *= ValueToDouble<TR, true>::Get(vv_r[me0_r++]);
+        ++num;
       }
-      me0_l = me1_l;
-      me0_r = me1_r;
+      mean.dbl = pow(prod, 1 / num);
+      m_value.Push(mi, mean);
     }
+    me0_l = me1_l;
+    me0_r = me1_r;
   }
 }
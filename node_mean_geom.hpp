@@ -39,6 +39,9 @@ class NodeMeanGeom: public NodeValue {
   private:
     NodeMeanGeom(NodeMeanGeom const &);
     NodeMeanGeom &operator=(NodeMeanGeom const &);
+    template <typename T> void MeanOne(Value const &);
+    template <typename TL, typename TR> void MeanTwo(Value const &, Value
+        const &);
 
     NodeValue *m_l;
     NodeValue *m_r;
@@ -30,6 +30,7 @@ NodeMember::NodeMember(std::string const &a_loc, NodeValue *a_child, char
   m_child(a_child),
   m_is_i()
 {
+  DepAdd(a_child);
   if (0 == strcmp(a_suffix, "I")) {
     m_is_i = true;
   } else if (0 == strcmp(a_suffix, "v") || 0 == strcmp(a_suffix, "E")) {
@@ -20,27 +20,131 @@
  */
 
 #include <node_mexpr.hpp>
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <util.hpp>
 
+namespace {
+
+bool IsBinary(NodeMExpr::Operation a_op)
+{
+  switch (a_op) {
+    case NodeMExpr::ADD:
+    case NodeMExpr::SUB:
+    case NodeMExpr::MUL:
+    case NodeMExpr::DIV:
+    case NodeMExpr::POW:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/*
+ * Right operands for the binary kernels, a column or a constant, so the
+ * same loop serves both.
+ */
+struct ColumnR {
+  double const *p;
+  double operator[](size_t a_i) const { return p[a_i]; }
+};
+struct ConstR {
+  double d;
+  double operator[](size_t) const { return d; }
+};
+
+/*
+ * Element-wise kernels, one plain loop per operation. The arithmetic and
+ * sqrt (with -fno-math-errno, see the Makefile) auto-vectorize, the other
+ * functions are at least tight libm call loops.
+ */
+#define MEXPR_LOOP(expr) do { \
+    for (size_t i = 0; i < a_n; ++i) { \
+      auto const l = a_l[i]; \
+      a_l[i] = expr; \
+    } \
+  } while (0)
+
+void Unary(NodeMExpr::Operation a_op, double *a_l, size_t a_n)
+{
+  switch (a_op) {
+    case NodeMExpr::COS:  MEXPR_LOOP(cos(l)); break;
+    case NodeMExpr::SIN:  MEXPR_LOOP(sin(l)); break;
+    case NodeMExpr::TAN:  MEXPR_LOOP(tan(l)); break;
+    case NodeMExpr::ACOS: MEXPR_LOOP(acos(l)); break;
+    case NodeMExpr::ASIN: MEXPR_LOOP(asin(l)); break;
+    case NodeMExpr::ATAN: MEXPR_LOOP(atan(l)); break;
+    case NodeMExpr::SQRT: MEXPR_LOOP(sqrt(l)); break;
+    case NodeMExpr::EXP:  MEXPR_LOOP(exp(l)); break;
+    case NodeMExpr::LOG:  MEXPR_LOOP(log(l)); break;
+    case NodeMExpr::ABS:  MEXPR_LOOP(std::abs(l)); break;
+    default:
+      throw std::runtime_error(__func__);
+  }
+}
+
+template <typename R> void Binary(NodeMExpr::Operation a_op, double *a_l,
+    R const &a_r, size_t a_n)
+{
+  switch (a_op) {
+    case NodeMExpr::ADD: MEXPR_LOOP(l + a_r[i]); break;
+    case NodeMExpr::SUB: MEXPR_LOOP(l - a_r[i]); break;
+    case NodeMExpr::MUL: MEXPR_LOOP(l * a_r[i]); break;
+    case NodeMExpr::DIV: MEXPR_LOOP(l / a_r[i]); break;
+    case NodeMExpr::POW: MEXPR_LOOP(pow(l, a_r[i])); break;
+    default:
+      throw std::runtime_error(__func__);
+  }
+}
+
+}
+
 NodeMExpr::NodeMExpr(std::string const &a_loc, NodeValue *a_l, NodeValue *a_r,
     double a_d, Operation a_op):
   NodeValue(a_loc),
-  m_l(a_l),
-  m_r(a_r),
-  m_d(a_d),
-  m_mix(),
-  m_op(a_op),
+  m_leaf_vec(),
+  m_prog(),
+  m_depth(),
+  m_arg_vec(),
+  m_row_n_vec(),
+  m_col_vec(),
   m_value()
 {
-  if (a_l && a_r) {
-    m_mix = 0;
-  } else if (a_l) {
-    m_mix = 1;
+  OperandAdd(a_l, a_d);
+  if (IsBinary(a_op)) {
+    OperandAdd(a_r, a_d);
+  }
+  if (IsBinary(a_op) && Instr::kConst == m_prog.back().kind) {
+    m_prog.back().kind = Instr::kOpConst;
+    m_prog.back().op = a_op;
   } else {
-    m_mix = 2;
+    Instr instr;
+    instr.kind = Instr::kOp;
+    instr.op = a_op;
+    instr.leaf = 0;
+    instr.d = 0.0;
+    m_prog.push_back(instr);
+  }
+
+  size_t depth = 0;
+  for (auto it = m_prog.begin(); m_prog.end() != it; ++it) {
+    switch (it->kind) {
+      case Instr::kLeaf:
+      case Instr::kConst:
+        m_depth = std::max(m_depth, ++depth);
+        break;
+      case Instr::kOp:
+        if (IsBinary(it->op)) {
+          --depth;
+        }
+        break;
+      case Instr::kOpConst:
+        break;
+    }
   }
+  assert(1 == depth);
+  m_arg_vec.resize(m_leaf_vec.size());
 }
 
 Value const &NodeMExpr::GetValue(uint32_t a_ret_i)
@@ -49,110 +153,170 @@ Value const &NodeMExpr::GetValue(uint32_t a_ret_i)
   return m_value;
 }
 
+/*
+ * Converts the paired elements of a leaf into a column.
+ */
+template <typename T> void NodeMExpr::Gather(Arg const &a_arg, double
+    *a_col)
+{
+  auto p = a_col;
+  for (uint32_t i = 0; i < m_row_n_vec.size(); ++i) {
+    uint32_t vi = 0 == i ? 0 : a_arg.me[i - 1];
+    uint32_t n = m_row_n_vec[i];
+    for (uint32_t k = 0; k < n; ++k) {
+      p[k] = ValueToDouble<T, true>::Get(a_arg.v[vi + k]);
+    }
+    p += n;
+  }
+}
+
+/*
+ * Adds an operand to the program, a missing node is the constant, and
+ * another expression has its program inlined.
+ */
+void NodeMExpr::OperandAdd(NodeValue *a_node, double a_d)
+{
+  auto expr = dynamic_cast<NodeMExpr *>(a_node);
+  if (expr) {
+    for (auto it = expr->m_prog.begin(); expr->m_prog.end() != it; ++it) {
+      auto instr = *it;
+      if (Instr::kLeaf == instr.kind) {
+        instr.leaf = LeafAdd(expr->m_leaf_vec.at(instr.leaf));
+      }
+      m_prog.push_back(instr);
+    }
+    return;
+  }
+  Instr instr;
+  instr.op = ADD;
+  instr.leaf = 0;
+  instr.d = 0.0;
+  if (a_node) {
+    instr.kind = Instr::kLeaf;
+    instr.leaf = LeafAdd(a_node);
+  } else {
+    instr.kind = Instr::kConst;
+    instr.d = a_d;
+  }
+  m_prog.push_back(instr);
+}
+
+uint32_t NodeMExpr::LeafAdd(NodeValue *a_node)
+{
+  for (uint32_t i = 0; i < m_leaf_vec.size(); ++i) {
+    if (a_node == m_leaf_vec[i]) {
+      return i;
+    }
+  }
+  DepAdd(a_node);
+  m_leaf_vec.push_back(a_node);
+  return (uint32_t)m_leaf_vec.size() - 1;
+}
+
 void NodeMExpr::Process(uint64_t a_evid)
 {
   NODE_PROCESS_GUARD(a_evid);
-  Value const *val_l = nullptr;
-  Value const *val_r = nullptr;
-  if (m_l) {
-    NODE_PROCESS(m_l, a_evid);
-    val_l = &m_l->GetValue();
-    if (Input::kNone == val_l->GetType() ||
-        val_l->GetMI().empty()) {
+
+  m_value.Clear();
+
+  for (size_t j = 0; j < m_leaf_vec.size(); ++j) {
+    auto leaf = m_leaf_vec[j];
+    NODE_PROCESS(leaf, a_evid);
+    auto const &val = leaf->GetValue();
+    if (Input::kNone == val.GetType() ||
+        val.GetMI().empty()) {
       return;
     }
-  }
-  if (m_r) {
-    NODE_PROCESS(m_r, a_evid);
-    val_r = &m_r->GetValue();
-    if (Input::kNone == val_r->GetType() ||
-        val_r->GetMI().empty()) {
-      return;
+    auto &arg = m_arg_vec[j];
+    arg.mi = val.GetMISpan();
+    arg.me = val.GetMESpan();
+    arg.is_u64 = Input::kUint64 == val.GetType();
+    arg.v = val.GetVSpan();
+    if (arg.mi.size() != m_arg_vec[0].mi.size()) {
+      std::cerr << GetLocStr() << ": Data operands not index-matched!\n";
+      throw std::runtime_error(__func__);
     }
   }
 
-  m_value.Clear();
   m_value.SetType(Input::kDouble);
 
-  uint32_t vi_l = 0;
-  uint32_t vi_r = 0;
-  for (uint32_t i = 0;; ++i) {
-    uint32_t mi;
-    uint32_t me_l = 1;
-    uint32_t me_r = 1;
-    if (0 == m_mix) {
-      auto done_l = i == val_l->GetMI().size();
-      auto done_r = i == val_r->GetMI().size();
-      if (done_l && done_r) {
-        break;
-      }
-      if (done_l || done_r) {
+  // Operands pair up per channel until the shortest runs out.
+  auto const &arg0 = m_arg_vec[0];
+  auto row_num = arg0.mi.size();
+  m_row_n_vec.resize(row_num);
+  size_t n_tot = 0;
+  for (uint32_t i = 0; i < row_num; ++i) {
+    auto mi = arg0.mi[i];
+    uint32_t n = UINT32_MAX;
+    for (auto it = m_arg_vec.begin(); m_arg_vec.end() != it; ++it) {
+      if (it->mi[i] != mi) {
         std::cerr << GetLocStr() << ": Data operands not index-matched!\n";
         throw std::runtime_error(__func__);
       }
-      auto mi_l = val_l->GetMI().at(i);
-      auto mi_r = val_r->GetMI().at(i);
-      if (mi_l != mi_r) {
-        std::cerr << GetLocStr() << ": Data operands not index-matched!\n";
-        throw std::runtime_error(__func__);
-      }
-      mi = mi_l;
-      me_l = val_l->GetME().at(i);
-      me_r = val_r->GetME().at(i);
-    } else if (1 == m_mix) {
-      if (i == val_l->GetMI().size()) {
+      n = std::min(n, it->me[i] - (0 == i ? 0 : it->me[i - 1]));
+    }
+    m_row_n_vec[i] = n;
+    n_tot += n;
+  }
+  if (m_col_vec.size() < m_depth * n_tot) {
+    m_col_vec.resize(m_depth * n_tot);
+  }
+
+  auto col = m_col_vec.data();
+  size_t top = 0;
+  for (auto it = m_prog.begin(); m_prog.end() != it; ++it) {
+    switch (it->kind) {
+      case Instr::kLeaf:
+        {
+          auto const &arg = m_arg_vec[it->leaf];
+          auto dst = col + top++ * n_tot;
+          if (arg.is_u64) {
+            Gather<uint64_t>(arg, dst);
+          } else {
+            Gather<double>(arg, dst);
+          }
+        }
         break;
-      }
-      mi = val_l->GetMI().at(i);
-      me_l = val_l->GetME().at(i);
-    } else {
-      if (i == val_r->GetMI().size()) {
+      case Instr::kConst:
+        {
+          auto dst = col + top++ * n_tot;
+          std::fill(dst, dst + n_tot, it->d);
+        }
         break;
-      }
-      mi = val_r->GetMI().at(i);
-      me_r = val_r->GetME().at(i);
-    }
-    for (;;) {
-      double v, l = 0.0, r = 0.0;
-      auto done_l = vi_l == me_l;
-      auto done_r = vi_r == me_r;
-      if (done_l || done_r) {
+      case Instr::kOp:
+        if (IsBinary(it->op)) {
+          --top;
+          ColumnR r;
+          r.p = col + top * n_tot;
+          Binary(it->op, col + (top - 1) * n_tot, r, n_tot);
+        } else {
+          Unary(it->op, col + (top - 1) * n_tot, n_tot);
+        }
         break;
-      }
-      if (0 == m_mix) {
-        l = val_l->GetV(vi_l++, true);
-        r = val_r->GetV(vi_r++, true);
-      } else if (1 == m_mix) {
-        l = val_l->GetV(vi_l++, true);
-        r = m_d;
-      } else {
-        l = m_d;
-        r = val_r->GetV(vi_r++, true);
-      }
-      switch (m_op) {
-        case ADD:  v = l + r; break;
-        case SUB:  v = l - r; break;
-        case MUL:  v = l * r; break;
-        case DIV:  v = l / r; break;
-        case COS:  v = cos(l); break;
-        case SIN:  v = sin(l); break;
-        case TAN:  v = tan(l); break;
-        case ACOS: v = acos(l); break;
-        case ASIN: v = asin(l); break;
-        case ATAN: v = atan(l); break;
-        case SQRT: v = sqrt(l); break;
-        case EXP:  v = exp(l); break;
-        case LOG:  v = log(l); break;
-        case ABS:  v = std::abs(l); break;
-        case POW:  v = pow(l, r); break;
-      }
+      case Instr::kOpConst:
+        {
+          ConstR r;
+          r.d = it->d;
+          Binary(it->op, col + (top - 1) * n_tot, r, n_tot);
+        }
+        break;
+    }
+  }
+  assert(1 == top);
+
+  m_value.Reserve(row_num, n_tot);
+  auto p = col;
+  for (uint32_t i = 0; i < row_num; ++i) {
+    auto mi = arg0.mi[i];
+    auto n = m_row_n_vec[i];
+    for (uint32_t k = 0; k < n; ++k) {
+      auto v = p[k];
       if (!std::isnan(v) && !std::isinf(v)) {
         Input::Scalar s;
         s.dbl = v;
         m_value.Push(mi, s);
       }
     }
-    vi_l = me_l;
-    vi_r = me_r;
+    p += n;
   }
 }
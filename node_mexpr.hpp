@@ -22,11 +22,19 @@
 #ifndef NODE_MEXPR_HPP
 #define NODE_MEXPR_HPP
 
+#include <vector>
 #include <node.hpp>
 #include <value.hpp>
 
 /*
- * Simple mathematical expressions of the form f(node, constant).
+ * Mathematical expressions of the form f(node, constant).
+ * Operands which are themselves expressions are fused into this node, so a
+ * whole formula such as "a*sqrt(1/(b*b)-1)" is one postfix program over the
+ * leaf operands. Each instruction runs over the whole event as a contiguous
+ * column of doubles, with the operation hoisted out of the loop so the
+ * compiler can vectorize it.
+ * Non-finite results are dropped, but only for the final value, i.e.
+ * "1/(1/0)" yields 0.
  */
 class NodeMExpr: public NodeValue {
   public:
@@ -55,12 +63,40 @@ class NodeMExpr: public NodeValue {
   private:
     NodeMExpr(NodeMExpr const &);
     NodeMExpr &operator=(NodeMExpr const &);
+    // Leaves and constants push a column, operations pop their operands and
+    // push the result. kOpConst is a binary operation with the constant as
+    // right operand, which saves filling a column.
+    struct Instr {
+      enum Kind {
+        kLeaf,
+        kConst,
+        kOp,
+        kOpConst
+      } kind;
+      Operation op;
+      uint32_t leaf;
+      double d;
+    };
+    // Per-event view of a leaf value.
+    struct Arg {
+      Arg(): mi(), me(), v(), is_u64() {}
+      Span<uint32_t> mi;
+      Span<uint32_t> me;
+      Span<Input::Scalar> v;
+      bool is_u64;
+    };
+    void OperandAdd(NodeValue *, double);
+    uint32_t LeafAdd(NodeValue *);
+    template <typename T> void Gather(Arg const &, double *);
 
-    NodeValue *m_l;
-    NodeValue *m_r;
-    double m_d;
-    int m_mix;
-    Operation m_op;
+    std::vector<NodeValue *> m_leaf_vec;
+    std::vector<Instr> m_prog;
+    size_t m_depth;
+    std::vector<Arg> m_arg_vec;
+    // # of paired elements per channel this event.
+    std::vector<uint32_t> m_row_n_vec;
+    // m_depth columns of all paired elements this event.
+    std::vector<double> m_col_vec;
     Value m_value;
 };
 
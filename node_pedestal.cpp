@@ -26,6 +26,7 @@
 #include <util.hpp>
 
 #define STATS_MAX 10000
+#define PEDESTAL_SYNC_EVENTS 64
 
 void NodePedestal::StatPage::Add(double a_v)
 {
@@ -43,6 +44,23 @@ void NodePedestal::StatPage::Add(double a_v)
   }
 }
 
+void NodePedestal::Stats::Add(double a_v)
+{
+  page[write_i].Add(a_v);
+}
+
+void NodePedestal::Stats::Flip()
+{
+  if (STATS_MAX <= page[write_i].num) {
+    write_i ^= 1;
+    auto &p = page[write_i];
+    p.num = 0;
+    p.mean = 0.0;
+    p.M2 = 0.0;
+    p.var = 0.0;
+  }
+}
+
 void NodePedestal::Stats::Get(double *a_mean, double *a_var)
 {
   uint32_t num = 0;
@@ -67,8 +85,15 @@ NodePedestal::NodePedestal(std::string const &a_loc, NodeValue *a_child,
   m_tpat(a_tpat),
   m_value(),
   m_sigma(),
-  m_stats()
+  m_primary(this),
+  m_stats_mutex(),
+  m_stats(),
+  m_pending_vec(),
+  m_local_est(),
+  m_event_n()
 {
+  DepAdd(a_child);
+  DepAdd(a_tpat);
   m_value.SetType(Input::kDouble);
   m_sigma.SetType(Input::kDouble);
 }
@@ -102,9 +127,56 @@ void NodePedestal::Process(uint64_t a_evid)
   m_sigma.Clear();
 
   auto const &val = m_child->GetValue();
-  auto const &vmi = val.GetMI();
-  auto const &vme = val.GetME();
+  if (this == m_primary) {
+    ProcessPrimary(val, do_accounting);
+    return;
+  }
 
+  auto vmi = val.GetMISpan();
+  auto vme = val.GetMESpan();
+  if (!vmi.empty() && vmi.back() >= m_local_est.size()) {
+    m_local_est.resize(vmi.back() + 1);
+  }
+  uint32_t v_i = 0;
+  for (uint32_t i = 0; i < vmi.size(); ++i) {
+    auto const mi = vmi[i];
+    auto const me = vme[i];
+    if (mi >= m_local_est.size()) {
+      m_local_est.resize(mi + 1);
+    }
+    auto mean = m_local_est[mi].first;
+    auto var = m_local_est[mi].second;
+    for (; v_i < me; ++v_i) {
+      auto v = val.GetV(v_i, true);
+      if (do_accounting) {
+        m_pending_vec.push_back(std::make_pair(mi, v));
+      }
+      if (var > 0) {
+        Input::Scalar scl;
+        auto std = sqrt(var);
+        auto e = v - mean;
+        if (e > m_cutoff * std) {
+          scl.dbl = e;
+          m_value.Push(mi, scl);
+        }
+        scl.dbl = std;
+        m_sigma.Push(mi, scl);
+      }
+    }
+  }
+  // Sync every event while warming up.
+  ++m_event_n;
+  if (m_event_n <= PEDESTAL_SYNC_EVENTS ||
+      0 == m_event_n % PEDESTAL_SYNC_EVENTS) {
+    Sync();
+  }
+}
+
+void NodePedestal::ProcessPrimary(Value const &a_val, bool a_do_accounting)
+{
+  const std::lock_guard<std::mutex> lock(m_stats_mutex);
+  auto vmi = a_val.GetMISpan();
+  auto vme = a_val.GetMESpan();
   if (!vmi.empty()) {
     // Try to size stats by looking at the last index.
     StatsFit(vmi.back());
@@ -114,12 +186,11 @@ void NodePedestal::Process(uint64_t a_evid)
     auto const mi = vmi[i];
     auto const me = vme[i];
     StatsFit(mi);
-    auto &s = m_stats.at(mi);
-    auto &s_write = s.page[s.write_i];
+    auto &s = m_stats[mi];
     for (; v_i < me; ++v_i) {
-      auto v = val.GetV(v_i, true);
-      if (do_accounting) {
-        s_write.Add(v);
+      auto v = a_val.GetV(v_i, true);
+      if (a_do_accounting) {
+        s.Add(v);
       }
       double mean, var;
       s.Get(&mean, &var);
@@ -135,20 +206,39 @@ void NodePedestal::Process(uint64_t a_evid)
         m_sigma.Push(mi, scl);
       }
     }
-    if (STATS_MAX <= s_write.num) {
-      s.write_i ^= 1;
-      auto &s_new = s.page[s.write_i];
-      s_new.num = 0;
-      s_new.mean = 0.0;
-      s_new.M2 = 0.0;
-      s_new.var = 0.0;
-    }
+    s.Flip();
   }
 }
 
+void NodePedestal::SetPrimary(NodePedestal *a_primary)
+{
+  m_primary = a_primary;
+}
+
 void NodePedestal::StatsFit(uint32_t a_mi)
 {
   if (a_mi >= m_stats.size()) {
     m_stats.resize(a_mi + 1);
   }
 }
+
+void NodePedestal::Sync()
+{
+  // Samples are accounted one by one, so pages flip exactly when full.
+  auto &primary = *m_primary;
+  const std::lock_guard<std::mutex> lock(primary.m_stats_mutex);
+  for (auto it = m_pending_vec.begin(); m_pending_vec.end() != it; ++it) {
+    primary.StatsFit(it->first);
+    auto &s = primary.m_stats[it->first];
+    s.Add(it->second);
+    s.Flip();
+  }
+  m_pending_vec.clear();
+  if (m_local_est.size() < primary.m_stats.size()) {
+    m_local_est.resize(primary.m_stats.size());
+  }
+  for (size_t mi = 0; mi < primary.m_stats.size(); ++mi) {
+    primary.m_stats[mi].Get(&m_local_est[mi].first,
+        &m_local_est[mi].second);
+  }
+}
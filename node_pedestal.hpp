@@ -22,23 +22,32 @@
 #ifndef NODE_PEDESTAL_HPP
 #define NODE_PEDESTAL_HPP
 
+#include <mutex>
 #include <vector>
 #include <node.hpp>
 #include <value.hpp>
 
 /*
  * On-the-fly pedestal subtraction.
+ * The statistics live in the primary node, which accounts and subtracts
+ * under its lock sample by sample. Replicas keep the samples to account and
+ * subtract with local estimates, both are synced with the primary under its
+ * lock every PEDESTAL_SYNC_EVENTS events, and every event for the first as
+ * many events.
  */
 class NodePedestal: public NodeValue {
   public:
     NodePedestal(std::string const &, NodeValue *, double, NodeValue *);
     Value const &GetValue(uint32_t);
     void Process(uint64_t);
+    void SetPrimary(NodePedestal *);
 
   private:
     NodePedestal(NodePedestal const &);
     NodePedestal &operator=(NodePedestal const &);
+    void ProcessPrimary(Value const &, bool);
     void StatsFit(uint32_t);
+    void Sync();
 
     struct StatPage {
       uint32_t num;
@@ -50,6 +59,8 @@ class NodePedestal: public NodeValue {
     struct Stats {
       StatPage page[2];
       size_t write_i;
+      void Add(double);
+      void Flip();
       void Get(double *, double *);
     };
     NodeValue *m_child;
@@ -57,7 +68,14 @@ class NodePedestal: public NodeValue {
     NodeValue *m_tpat;
     Value m_value;
     Value m_sigma;
+    NodePedestal *m_primary;
+    std::mutex m_stats_mutex;
     std::vector<Stats> m_stats;
+    // Replicas: channel and value of samples to account, and per channel
+    // mean/variance as of the last sync.
+    std::vector<std::pair<uint32_t, double>> m_pending_vec;
+    std::vector<std::pair<double, double>> m_local_est;
+    uint64_t m_event_n;
 };
 
 #endif
@@ -30,6 +30,7 @@ NodeSelectIndex::NodeSelectIndex(std::string const &a_loc, NodeValue *a_child,
   m_last(a_last),
   m_value()
 {
+  DepAdd(a_child);
   assert(m_first <= m_last);
 }
 
@@ -49,9 +50,9 @@ void NodeSelectIndex::Process(uint64_t a_evid)
   auto const &val = m_child->GetValue();
   m_value.SetType(val.GetType());
 
-  auto const &vmi = val.GetMI();
-  auto const &vme = val.GetME();
-  auto const &vv = val.GetV();
+  auto vmi = val.GetMISpan();
+  auto vme = val.GetMESpan();
+  auto vv = val.GetVSpan();
 
   for (uint32_t i = 0; i < vmi.size(); ++i) {
     auto mi = vmi[i];
@@ -102,7 +102,8 @@ void NodeSignal::Process(uint64_t a_evid)
   m_value.Clear();
 
 #define FETCH_SIGNAL_DATA(SUFF) \
-  auto const pair_##SUFF = m_config->GetInput()->GetData(m_##SUFF->id); \
+  auto const pair_##SUFF = m_config->GetInput()->GetData( \
+      m_config->GetInputSlot(), m_##SUFF->id); \
   auto const p_##SUFF = pair_##SUFF.first; \
   auto const len_##SUFF = pair_##SUFF.second
 #define SIGNAL_LEN_CHECK(l, op, r) do { \
@@ -125,10 +126,12 @@ void NodeSignal::Process(uint64_t a_evid)
     FETCH_SIGNAL_DATA();
     FETCH_SIGNAL_DATA(v);
     SIGNAL_LEN_CHECK(1U, ==, len_M);
+    SIGNAL_LEN_CHECK(p_M->u64, <=, len_MI);
     SIGNAL_LEN_CHECK(len_ME, ==, len_MI);
     SIGNAL_LEN_CHECK(1U, ==, len_);
     SIGNAL_LEN_CHECK(p_->u64, <=, len_v);
     m_value.SetType(m_v->type);
+    m_value.Reserve(p_M->u64, p_->u64);
     uint32_t v_i = 0;
     switch (m_v->type) {
 #define COPY_M_HIT(input_type, member) \
@@ -158,6 +161,7 @@ void NodeSignal::Process(uint64_t a_evid)
     SIGNAL_LEN_CHECK(p_->u64, <=, len_MI);
     SIGNAL_LEN_CHECK(p_->u64, <=, len_v);
     m_value.SetType(m_v->type);
+    m_value.Reserve(p_->u64, p_->u64);
     switch (m_v->type) {
 #define COPY_S_HIT(input_type, member) \
     case Input::input_type: \
@@ -181,6 +185,7 @@ void NodeSignal::Process(uint64_t a_evid)
     SIGNAL_LEN_CHECK(1U, ==, len_);
     SIGNAL_LEN_CHECK(p_->u64, <=, len_v);
     m_value.SetType(m_v->type);
+    m_value.Reserve(1, p_->u64);
     switch (m_v->type) {
 #define COPY_INDEX(input_type, member) \
       case Input::input_type: \
@@ -200,6 +205,7 @@ void NodeSignal::Process(uint64_t a_evid)
     // Scalar or simple array.
     FETCH_SIGNAL_DATA();
     m_value.SetType(m_->type);
+    m_value.Reserve(1, len_);
     switch (m_->type) {
 #define COPY_SCALAR(input_type, member) \
       case Input::input_type: \
@@ -32,6 +32,8 @@ NodeSubMod::NodeSubMod(std::string const &a_loc, NodeValue *a_l, NodeValue
   m_range(a_range),
   m_value()
 {
+  DepAdd(a_l);
+  DepAdd(a_r);
 }
 
 Value const &NodeSubMod::GetValue(uint32_t a_ret_i)
@@ -57,15 +59,21 @@ void NodeSubMod::Process(uint64_t a_evid)
   NODE_ASSERT(val_l.GetType(), ==, val_r.GetType());
   m_value.SetType(Input::kDouble);
 
+  auto miv_l = val_l.GetMISpan();
+  auto mev_l = val_l.GetMESpan();
+  auto miv_r = val_r.GetMISpan();
+  auto mev_r = val_r.GetMESpan();
+  auto vv_l = val_l.GetVSpan();
+  auto vv_r = val_r.GetVSpan();
   uint32_t i_l = 0;
   uint32_t i_r = 0;
   uint32_t vi_l = 0;
   uint32_t vi_r = 0;
-  while (i_l < val_l.GetMI().size() && i_r < val_r.GetMI().size()) {
-    auto mi_l = val_l.GetMI()[i_l];
-    auto mi_r = val_r.GetMI()[i_r];
-    auto me_l = val_l.GetME()[i_l];
-    auto me_r = val_r.GetME()[i_r];
+  while (i_l < miv_l.size() && i_r < miv_r.size()) {
+    auto mi_l = miv_l[i_l];
+    auto mi_r = miv_r[i_r];
+    auto me_l = mev_l[i_l];
+    auto me_r = mev_r[i_r];
     if (mi_l < mi_r) {
       ++i_l;
       vi_l = me_l;
@@ -76,12 +84,12 @@ void NodeSubMod::Process(uint64_t a_evid)
       while (vi_l < me_l && vi_r < me_r) {
         Input::Scalar diff;
         if (Input::kDouble == val_l.GetType()) {
-          auto l = val_l.GetV(vi_l, false);
-          auto r = val_r.GetV(vi_r, false);
+          auto l = vv_l[vi_l].dbl;
+          auto r = vv_r[vi_r].dbl;
           diff.dbl = SubModDbl(l, r, m_range);
         } else {
-          auto l = val_l.GetV().at(vi_l).u64;
-          auto r = val_r.GetV().at(vi_r).u64;
+          auto l = vv_l[vi_l].u64;
+          auto r = vv_r[vi_r].u64;
           diff.dbl = SubModU64(l, r, m_range);
         }
         m_value.Push(mi_l, diff);
@@ -31,6 +31,8 @@ NodeTot::NodeTot(std::string const &a_loc, NodeValue *a_l, NodeValue *a_t,
   m_range(a_range),
   m_value()
 {
+  DepAdd(a_l);
+  DepAdd(a_t);
 }
 
 Value const &NodeTot::GetValue(uint32_t a_ret_i)
@@ -52,15 +54,38 @@ void NodeTot::Process(uint64_t a_evid)
   NODE_ASSERT(val_l.GetType(), ==, val_t.GetType());
   m_value.SetType(Input::kDouble);
 
+  switch (val_l.GetType()) {
+    case Input::kNone:
+      break;
+    case Input::kUint64:
+      Tot<uint64_t>(val_l, val_t);
+      break;
+    case Input::kDouble:
+      Tot<double>(val_l, val_t);
+      break;
+    default:
+      throw std::runtime_error(__func__);
+  }
+}
+
+template <typename T> void NodeTot::Tot(Value const &a_val_l, Value const
+    &a_val_t)
+{
+  auto miv_l = a_val_l.GetMISpan();
+  auto mev_l = a_val_l.GetMESpan();
+  auto miv_t = a_val_t.GetMISpan();
+  auto mev_t = a_val_t.GetMESpan();
+  auto vv_l = a_val_l.GetVSpan();
+  auto vv_t = a_val_t.GetVSpan();
   uint32_t i_l = 0;
   uint32_t i_t = 0;
   uint32_t vi_l = 0;
   uint32_t vi_t = 0;
-  while (i_l < val_l.GetMI().size() && i_t < val_t.GetMI().size()) {
-    auto mi_l = val_l.GetMI()[i_l];
-    auto mi_t = val_t.GetMI()[i_t];
-    auto me_l = val_l.GetME()[i_l];
-    auto me_t = val_t.GetME()[i_t];
+  while (i_l < miv_l.size() && i_t < miv_t.size()) {
+    auto mi_l = miv_l[i_l];
+    auto mi_t = miv_t[i_t];
+    auto me_l = mev_l[i_l];
+    auto me_t = mev_t[i_t];
     if (mi_l < mi_t) {
       ++i_l;
       vi_l = me_l;
@@ -69,8 +94,8 @@ void NodeTot::Process(uint64_t a_evid)
       vi_t = me_t;
     } else {
       while (vi_l < me_l && vi_t < me_t) {
-        double l = val_l.GetV(vi_l, false);
-        double t = val_t.GetV(vi_t, false);
+        double l = ValueToDouble<T, false>::Get(vv_l[vi_l]);
+        double t = ValueToDouble<T, false>::Get(vv_t[vi_t]);
         double d = SubModDbl(t, l, m_range);
         if (d > 0) {
           Input::Scalar diff;
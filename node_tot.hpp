@@ -37,6 +37,7 @@ class NodeTot: public NodeValue {
   private:
     NodeTot(NodeTot const &);
     NodeTot &operator=(NodeTot const &);
+    template <typename T> void Tot(Value const &, Value const &);
 
     NodeValue *m_l;
     NodeValue *m_t;
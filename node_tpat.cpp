@@ -29,6 +29,7 @@ NodeTpat::NodeTpat(std::string const &a_loc, NodeValue *a_tpat, uint32_t
   m_mask(a_mask),
   m_value()
 {
+  DepAdd(a_tpat);
 }
 
 Value const &NodeTpat::GetValue(uint32_t a_ret_i)
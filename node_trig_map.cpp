@@ -32,6 +32,8 @@ NodeTrigMap::NodeTrigMap(std::string const &a_loc, TrigMap::Prefix const
   m_range(a_range),
   m_value()
 {
+  DepAdd(a_sig);
+  DepAdd(a_trig);
 }
 
 Value const &NodeTrigMap::GetValue(uint32_t a_ret_i)
@@ -52,24 +54,26 @@ void NodeTrigMap::Process(uint64_t a_evid)
   // Build trigger lookup vector.
   std::vector<double> trig_vec;
   auto const &val_trig = m_trig->GetValue();
-  auto const &vmi_trig = val_trig.GetMI();
+  auto vmi_trig = val_trig.GetMISpan();
+  auto vme_trig = val_trig.GetMESpan();
   uint32_t vi = 0;
   for (uint32_t i = 0; i < vmi_trig.size(); ++i) {
-    uint32_t mi = vmi_trig.at(i);
+    uint32_t mi = vmi_trig[i];
     if (mi >= trig_vec.size()) {
       trig_vec.resize(mi + 1);
     }
     trig_vec.at(mi) = val_trig.GetV(vi, false);
-    vi = val_trig.GetME().at(i);
+    vi = vme_trig[i];
   }
 
   auto const &val_sig = m_sig->GetValue();
-  auto const &vmi_sig = val_sig.GetMI();
+  auto vmi_sig = val_sig.GetMISpan();
+  auto vme_sig = val_sig.GetMESpan();
 
   vi = 0;
   for (uint32_t i = 0; i < vmi_sig.size(); ++i) {
     auto mi = vmi_sig[i];
-    auto me_sig = val_sig.GetME().at(i);
+    auto me_sig = vme_sig[i];
     for (; vi < me_sig; ++vi) {
       double sig = val_sig.GetV(vi, false);
       uint32_t trig_i;
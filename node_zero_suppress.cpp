@@ -30,6 +30,7 @@ NodeZeroSuppress::NodeZeroSuppress(std::string const &a_loc, NodeValue
   m_cutoff(a_cutoff),
   m_value()
 {
+  DepAdd(a_child);
 }
 
 Value const &NodeZeroSuppress::GetValue(uint32_t a_ret_i)
@@ -48,17 +49,32 @@ void NodeZeroSuppress::Process(uint64_t a_evid)
   m_value.Clear();
   m_value.SetType(val.GetType());
 
-  auto const &vmi = val.GetMI();
-  auto const &vme = val.GetME();
+  switch (val.GetType()) {
+    case Input::kNone:
+      break;
+    case Input::kUint64:
+      Suppress<uint64_t>(val);
+      break;
+    case Input::kDouble:
+      Suppress<double>(val);
+      break;
+    default:
+      throw std::runtime_error(__func__);
+  }
+}
+
+template <typename T> void NodeZeroSuppress::Suppress(Value const &a_val)
+{
+  auto vmi = a_val.GetMISpan();
+  auto vme = a_val.GetMESpan();
+  auto vv = a_val.GetVSpan();
   uint32_t vi = 0;
   for (uint32_t i = 0; i < vmi.size(); ++i) {
-    auto mi = vmi.at(i);
-    auto me = vme.at(i);
+    auto mi = vmi[i];
+    auto me = vme[i];
     for (; vi < me; ++vi) {
-      auto v = val.GetV(vi, false);
-      if (v >= m_cutoff) {
-        Input::Scalar s = val.GetV().at(vi);
-        m_value.Push(mi, s);
+      if (ValueToDouble<T, false>::Get(vv[vi]) >= m_cutoff) {
+        m_value.Push(mi, vv[vi]);
       }
     }
   }
@@ -38,6 +38,7 @@ class NodeZeroSuppress: public NodeValue {
   private:
     NodeZeroSuppress(NodeZeroSuppress const &);
     NodeZeroSuppress &operator=(NodeZeroSuppress const &);
+    template <typename T> void Suppress(Value const &);
 
     NodeValue *m_child;
     double m_cutoff;
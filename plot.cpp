@@ -30,6 +30,9 @@
 
 #define LENGTH(x) (sizeof x / sizeof *x)
 
+// 2D histogram tiles are 2^n bins wide and high.
+#define TILE_BITS 6
+
 namespace {
   std::list<Page> g_page_list;
   Page *g_page_sel;
@@ -336,6 +339,8 @@ PlotHist::PlotHist(Page *a_page, std::string const &a_title, uint32_t a_xb,
   m_axis(),
   m_hist_mutex(),
   m_hist(),
+  m_gen(),
+  m_gen_copy(),
   m_axis_copy(),
   m_hist_copy(),
   m_is_log_y(),
@@ -365,14 +370,18 @@ void PlotHist::Draw(ImPlutt::Window *a_window, ImPlutt::Pos const &a_size)
       m_range.Clear();
       m_axis.Clear();
       m_hist.clear();
+      ++m_gen;
       m_plot_state.do_clear = false;
     }
-    m_axis_copy = m_axis;
-    if (m_hist_copy.size() != m_hist.size()) {
-      m_hist_copy.resize(m_hist.size());
+    if (m_gen_copy != m_gen) {
+      m_axis_copy = m_axis;
+      if (m_hist_copy.size() != m_hist.size()) {
+        m_hist_copy.resize(m_hist.size());
+      }
+      memcpy(m_hist_copy.data(), m_hist.data(),
+          m_hist.size() * sizeof m_hist[0]);
+      m_gen_copy = m_gen;
     }
-    memcpy(m_hist_copy.data(), m_hist.data(),
-        m_hist.size() * sizeof m_hist[0]);
   }
   if (m_hist_copy.empty()) {
     return;
@@ -438,10 +447,23 @@ void PlotHist::Draw(ImPlutt::Window *a_window, ImPlutt::Pos const &a_size)
   }
 }
 
-void PlotHist::Fill(Input::Type a_type, Input::Scalar const &a_x)
+void PlotHist::Fill(Input::Type a_type, Input::Scalar const *a_x, size_t
+    a_n)
 {
   const std::lock_guard<std::mutex> lock(m_hist_mutex);
 
+  for (size_t i = 0; i < a_n; ++i) {
+    m_range.Add(a_type, a_x[i]);
+  }
+  Fit();
+  for (size_t i = 0; i < a_n; ++i) {
+    FillOne(a_type, a_x[i]);
+  }
+  m_gen += 0 != a_n;
+}
+
+void PlotHist::FillOne(Input::Type a_type, Input::Scalar const &a_x)
+{
   // And the filling, at last.
   auto span = m_axis.max - m_axis.min;
   double dx;
@@ -462,8 +484,6 @@ void PlotHist::Fill(Input::Type a_type, Input::Scalar const &a_x)
 
 void PlotHist::Fit()
 {
-  const std::lock_guard<std::mutex> lock(m_hist_mutex);
-
   if (m_range.GetMin() < m_axis.min || m_range.GetMax() >= m_axis.max) {
     auto axis = m_range.GetExtents(m_xb);
     if (m_axis.bins != axis.bins ||
@@ -477,13 +497,6 @@ void PlotHist::Fit()
   }
 }
 
-void PlotHist::Prefill(Input::Type a_type, Input::Scalar const &a_x)
-{
-  const std::lock_guard<std::mutex> lock(m_hist_mutex);
-
-  m_range.Add(a_type, a_x);
-}
-
 // Fitters must work on given copy and not look at the ever-changing m_hist!
 void PlotHist::FitGauss(std::vector<uint32_t> const &a_hist, Axis const
     &a_axis)
@@ -590,12 +603,15 @@ PlotHist2::PlotHist2(Page *a_page, std::string const &a_title, size_t
   m_axis_y(),
   m_hist_mutex(),
   m_hist(),
+  m_gen(),
+  m_gen_copy(),
+  m_tile_nx(),
+  m_tile_dirty(),
   m_axis_x_copy(),
   m_axis_y_copy(),
   m_hist_copy(),
   m_is_log_z(),
-  m_plot_state(0),
-  m_pixels()
+  m_plot_state(0)
 {
   m_is_log_z.is_on = a_log_z;
 }
@@ -610,15 +626,36 @@ void PlotHist2::Draw(ImPlutt::Window *a_window, ImPlutt::Pos const &a_size)
       m_axis_x.Clear();
       m_axis_y.Clear();
       m_hist.clear();
+      TileReset();
+      ++m_gen;
       m_plot_state.do_clear = false;
     }
-    m_axis_x_copy = m_axis_x;
-    m_axis_y_copy = m_axis_y;
-    if (m_hist_copy.size() != m_hist.size()) {
-      m_hist_copy.resize(m_hist.size());
+    if (m_gen_copy != m_gen) {
+      m_axis_x_copy = m_axis_x;
+      m_axis_y_copy = m_axis_y;
+      if (m_hist_copy.size() != m_hist.size()) {
+        m_hist_copy.resize(m_hist.size());
+      }
+      // Copy dirty tiles row by row.
+      auto const nx = m_axis_x.bins;
+      auto const ny = m_axis_y.bins;
+      for (size_t t = 0; t < m_tile_dirty.size(); ++t) {
+        if (!m_tile_dirty[t]) {
+          continue;
+        }
+        m_tile_dirty[t] = 0;
+        auto j0 = (uint32_t)(t % m_tile_nx) << TILE_BITS;
+        auto i0 = (uint32_t)(t / m_tile_nx) << TILE_BITS;
+        auto j1 = std::min(j0 + (1U << TILE_BITS), nx);
+        auto i1 = std::min(i0 + (1U << TILE_BITS), ny);
+        for (auto i = i0; i < i1; ++i) {
+          auto ofs = i * nx + j0;
+          memcpy(&m_hist_copy[ofs], &m_hist[ofs],
+              (j1 - j0) * sizeof m_hist[0]);
+        }
+      }
+      m_gen_copy = m_gen;
     }
-    memcpy(m_hist_copy.data(), m_hist.data(),
-        m_hist.size() * sizeof m_hist[0]);
   }
   if (m_hist_copy.empty()) {
     return;
@@ -649,14 +686,28 @@ void PlotHist2::Draw(ImPlutt::Window *a_window, ImPlutt::Pos const &a_size)
       ImPlutt::Point(minx, miny),
       ImPlutt::Point(maxx, maxy),
       m_hist_copy, m_axis_y_copy.bins, m_axis_x_copy.bins,
-      m_pixels);
+      m_gen_copy);
 }
 
-void PlotHist2::Fill(Input::Type a_type_y, Input::Scalar const &a_y,
-    Input::Type a_type_x, Input::Scalar const &a_x)
+void PlotHist2::Fill(Input::Type a_type_y, Input::Scalar const *a_y,
+    Input::Type a_type_x, Input::Scalar const *a_x, size_t a_n)
 {
   const std::lock_guard<std::mutex> lock(m_hist_mutex);
 
+  for (size_t i = 0; i < a_n; ++i) {
+    m_range_x.Add(a_type_x, a_x[i]);
+    m_range_y.Add(a_type_y, a_y[i]);
+  }
+  Fit();
+  for (size_t i = 0; i < a_n; ++i) {
+    FillOne(a_type_y, a_y[i], a_type_x, a_x[i]);
+  }
+  m_gen += 0 != a_n;
+}
+
+void PlotHist2::FillOne(Input::Type a_type_y, Input::Scalar const &a_y,
+    Input::Type a_type_x, Input::Scalar const &a_x)
+{
   // Fill.
   auto span_x = m_axis_x.max - m_axis_x.min;
   auto span_y = m_axis_y.max - m_axis_y.min;
@@ -687,12 +738,11 @@ void PlotHist2::Fill(Input::Type a_type_y, Input::Scalar const &a_y,
   assert(i < m_axis_y.bins);
   assert(j < m_axis_x.bins);
   ++m_hist.at(i * m_axis_x.bins + j);
+  m_tile_dirty[(i >> TILE_BITS) * m_tile_nx + (j >> TILE_BITS)] = 1;
 }
 
 void PlotHist2::Fit()
 {
-  const std::lock_guard<std::mutex> lock(m_hist_mutex);
-
   if (m_range_x.GetMin() < m_axis_x.min ||
       m_range_x.GetMax() >= m_axis_x.max ||
       m_range_y.GetMin() < m_axis_y.min ||
@@ -712,20 +762,23 @@ void PlotHist2::Fit()
           axis_y.bins, axis_y.min, axis_y.max);
       m_axis_x = axis_x;
       m_axis_y = axis_y;
+      TileReset();
     }
   }
 }
 
-void PlotHist2::Prefill(Input::Type a_type_y, Input::Scalar const &a_y,
-    Input::Type a_type_x, Input::Scalar const &a_x)
+void PlotHist2::TileReset()
 {
-  const std::lock_guard<std::mutex> lock(m_hist_mutex);
-
-  m_range_x.Add(a_type_x, a_x);
-  m_range_y.Add(a_type_y, a_y);
+  // Layout changed, everything is dirty.
+  auto const tile_mask = (1U << TILE_BITS) - 1;
+  m_tile_nx = (m_axis_x.bins + tile_mask) >> TILE_BITS;
+  auto tile_ny = (m_axis_y.bins + tile_mask) >> TILE_BITS;
+  m_tile_dirty.assign(m_tile_nx * tile_ny, 1);
 }
 
-void plot(ImPlutt::Window *a_window, double a_event_rate)
+void plot(ImPlutt::Window *a_window, double a_event_rate, unsigned
+    a_queue_n, unsigned a_queue_size, uint64_t a_filter_accept_n, uint64_t
+    a_filter_reject_n)
 {
   if (g_page_list.empty()) {
     return;
@@ -751,6 +804,11 @@ void plot(ImPlutt::Window *a_window, double a_event_rate)
   } else {
     oss << a_event_rate * 1e-3 << "k";
   }
+  oss << "  Queue: " << a_queue_n << '/' << a_queue_size;
+  if (a_filter_accept_n || a_filter_reject_n) {
+    oss << "  Filter: " << a_filter_accept_n << " acc/" << a_filter_reject_n
+        << " rej";
+  }
   auto size1 = a_window->TextMeasure(ImPlutt::Window::TEXT_BOLD,
       oss.str().c_str());
 
@@ -116,12 +116,13 @@ class PlotHist: public Plot {
     PlotHist(Page *, std::string const &, uint32_t, LinearTransform const &,
         char const *, bool, double);
     void Draw(ImPlutt::Window *, ImPlutt::Pos const &);
-    void Fill(Input::Type, Input::Scalar const &);
-    void Fit();
-    void Prefill(Input::Type, Input::Scalar const &);
+    // Fills all values of one event under a single lock.
+    void Fill(Input::Type, Input::Scalar const *, size_t);
 
   private:
+    void Fit();
     void FitGauss(std::vector<uint32_t> const &, Axis const &);
+    void FillOne(Input::Type, Input::Scalar const &);
 
     std::string m_title;
     uint32_t m_xb;
@@ -131,6 +132,9 @@ class PlotHist: public Plot {
     Axis m_axis;
     std::mutex m_hist_mutex;
     std::vector<uint32_t> m_hist;
+    // Bumped on every change to m_hist, Draw only copies when it moved.
+    uint64_t m_gen;
+    uint64_t m_gen_copy;
     Axis m_axis_copy;
     std::vector<uint32_t> m_hist_copy;
     ImPlutt::CheckboxState m_is_log_y;
@@ -144,15 +148,18 @@ class PlotHist2: public Plot {
         LinearTransform const &, LinearTransform const &, char const *, bool,
         double);
     void Draw(ImPlutt::Window *, ImPlutt::Pos const &);
+    // Fills all y/x pairs of one event under a single lock.
     void Fill(
-        Input::Type, Input::Scalar const &,
-        Input::Type, Input::Scalar const &);
+        Input::Type, Input::Scalar const *,
+        Input::Type, Input::Scalar const *, size_t);
+
+  private:
     void Fit();
-    void Prefill(
+    void FillOne(
         Input::Type, Input::Scalar const &,
         Input::Type, Input::Scalar const &);
+    void TileReset();
 
-  private:
     std::string m_title;
     size_t m_colormap;
     uint32_t m_xb;
@@ -165,16 +172,22 @@ class PlotHist2: public Plot {
     Axis m_axis_y;
     std::mutex m_hist_mutex;
     std::vector<uint32_t> m_hist;
+    // Same as PlotHist, and m_hist is split into square tiles with dirty
+    // flags so Draw only copies tiles touched since the last copy.
+    uint64_t m_gen;
+    uint64_t m_gen_copy;
+    uint32_t m_tile_nx;
+    std::vector<uint8_t> m_tile_dirty;
     Axis m_axis_x_copy;
     Axis m_axis_y_copy;
     std::vector<uint32_t> m_hist_copy;
     ImPlutt::CheckboxState m_is_log_z;
     ImPlutt::PlotState m_plot_state;
-    std::vector<uint8_t> m_pixels;
 };
 
 // TODO: Should all this be global?
-void plot(ImPlutt::Window *, double);
+// The last two are event_filter accepted/rejected counts, 0/0 hides them.
+void plot(ImPlutt::Window *, double, unsigned, unsigned, uint64_t, uint64_t);
 // TODO: Change name...
 Page *plot_page_add();
 void plot_page_create(char const *);
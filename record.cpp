@@ -0,0 +1,265 @@
+/*
+ * plutt, a scriptable monitor for experimental data.
+ *
+ * Copyright (C) 2023  Hans Toshihide Toernqvist <hans.tornqvist@chalmers.se>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301  USA
+ */
+
+#include <record.hpp>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <iostream>
+#include <set>
+#include <stdexcept>
+#include <config.hpp>
+
+#define RECORD_MAGIC "PLUTTRC1"
+#define RECORD_PAD(n) (((n) + 7) & ~(size_t)7)
+
+Recorder::Recorder(Config const &a_config, char const *a_path):
+  m_path(a_path),
+  m_file(),
+  m_id_vec(),
+  m_data_vec()
+{
+  m_file = fopen(a_path, "wb");
+  if (!m_file) {
+    perror("fopen");
+    std::cerr << a_path << ": Could not open for recording.\n";
+    throw std::runtime_error(__func__);
+  }
+  auto const &binding_vec = a_config.GetBindingVec();
+  Put(RECORD_MAGIC, 8);
+  uint64_t u64 = binding_vec.size();
+  Put(&u64, sizeof u64);
+  for (auto it = binding_vec.begin(); binding_vec.end() != it; ++it) {
+    u64 = it->type;
+    Put(&u64, sizeof u64);
+    u64 = it->name.size();
+    Put(&u64, sizeof u64);
+    u64 = it->suffix.size();
+    Put(&u64, sizeof u64);
+    auto str = it->name + it->suffix;
+    str.resize(RECORD_PAD(str.size()), '\0');
+    Put(str.data(), str.size());
+    m_id_vec.push_back(it->id);
+  }
+  m_data_vec.resize(m_id_vec.size());
+  std::cout << a_path << ": Recording " << m_id_vec.size() <<
+      " signal members.\n";
+}
+
+Recorder::~Recorder()
+{
+  if (0 != fclose(m_file)) {
+    perror("fclose");
+  }
+}
+
+void Recorder::Put(void const *a_p, size_t a_bytes)
+{
+  if (0 == a_bytes) {
+    return;
+  }
+  if (1 != fwrite(a_p, a_bytes, 1, m_file)) {
+    perror("fwrite");
+    std::cerr << m_path << ": Could not write.\n";
+    throw std::runtime_error(__func__);
+  }
+}
+
+void Recorder::Write(Input *a_input, unsigned a_slot)
+{
+  uint64_t bytes = 0;
+  for (size_t i = 0; i < m_id_vec.size(); ++i) {
+    m_data_vec[i] = a_input->GetData(a_slot, m_id_vec[i]);
+    bytes += sizeof(uint64_t) + m_data_vec[i].second * sizeof(Input::Scalar);
+  }
+  Put(&bytes, sizeof bytes);
+  for (auto it = m_data_vec.begin(); m_data_vec.end() != it; ++it) {
+    uint64_t n = it->second;
+    Put(&n, sizeof n);
+    Put(it->first, it->second * sizeof(Input::Scalar));
+  }
+}
+
+Replay::Replay(Config &a_config, unsigned a_slot_num, char const *a_path):
+  m_path(a_path),
+  m_map(),
+  m_map_size(),
+  m_binding_n(),
+  m_ofs(),
+  m_ev_ofs(),
+  m_slot_vec(a_slot_num)
+{
+  auto fd = open(a_path, O_RDONLY);
+  if (-1 == fd) {
+    perror("open");
+    std::cerr << a_path << ": Could not open recording.\n";
+    throw std::runtime_error(__func__);
+  }
+  struct stat st;
+  if (-1 == fstat(fd, &st)) {
+    perror("fstat");
+    close(fd);
+    throw std::runtime_error(__func__);
+  }
+  m_map_size = (size_t)st.st_size;
+  if (m_map_size < 16) {
+    std::cerr << a_path << ": Not a recording.\n";
+    close(fd);
+    throw std::runtime_error(__func__);
+  }
+  auto map = mmap(nullptr, m_map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (MAP_FAILED == map) {
+    perror("mmap");
+    throw std::runtime_error(__func__);
+  }
+  m_map = (uint8_t const *)map;
+  madvise(map, m_map_size, MADV_SEQUENTIAL);
+  try {
+    Bind(a_config);
+  } catch (...) {
+    // The destructor will not run for a half-built object.
+    munmap(map, m_map_size);
+    throw;
+  }
+}
+
+Replay::~Replay()
+{
+  munmap((void *)m_map, m_map_size);
+}
+
+void Replay::Bind(Config &a_config)
+{
+  if (0 != memcmp(m_map, RECORD_MAGIC, 8)) {
+    std::cerr << m_path << ": Not a recording.\n";
+    throw std::runtime_error(__func__);
+  }
+  m_binding_n = *Get(8);
+  m_ofs = 16;
+
+  // Bind the members of the signals the config wants, by recorded index.
+  auto signal_list = a_config.GetSignalList();
+  std::set<std::string> signal_set(signal_list.begin(), signal_list.end());
+  std::set<std::string> bound_set;
+  for (size_t i = 0; i < m_binding_n; ++i) {
+    auto type = (Input::Type)*Get(m_ofs);
+    if (Input::kUint64 != type && Input::kDouble != type) {
+      std::cerr << m_path << ": Binding " << i << " has unknown type.\n";
+      throw std::runtime_error(__func__);
+    }
+    auto name_len = *Get(m_ofs + 8);
+    auto suffix_len = *Get(m_ofs + 16);
+    m_ofs += 24;
+    // Bound each length first so the sum and the padding cannot wrap.
+    auto left = m_map_size - m_ofs;
+    if (name_len > left || suffix_len > left ||
+        RECORD_PAD(name_len + suffix_len) > left) {
+      std::cerr << m_path << ": Truncated header.\n";
+      throw std::runtime_error(__func__);
+    }
+    auto str_len = RECORD_PAD(name_len + suffix_len);
+    auto p = (char const *)&m_map[m_ofs];
+    std::string name(p, name_len);
+    std::string suffix(p + name_len, suffix_len);
+    m_ofs += str_len;
+    if (signal_set.count(name)) {
+      a_config.BindSignal(name, suffix.c_str(), i, type);
+      bound_set.insert(name);
+    }
+  }
+  for (auto it = signal_set.begin(); signal_set.end() != it; ++it) {
+    if (!bound_set.count(*it)) {
+      std::cerr << *it << ": Signal not in recording.\n";
+      throw std::runtime_error(__func__);
+    }
+  }
+  for (auto it = m_slot_vec.begin(); m_slot_vec.end() != it; ++it) {
+    it->resize(m_binding_n);
+  }
+}
+
+void Replay::Buffer(unsigned a_slot)
+{
+  // Just point into the mapping, Fetch checked the layout.
+  auto &slot = m_slot_vec.at(a_slot);
+  auto ofs = m_ev_ofs;
+  for (size_t i = 0; i < m_binding_n; ++i) {
+    auto n = *Get(ofs);
+    ofs += 8;
+    slot[i] = std::make_pair((Input::Scalar const *)&m_map[ofs], n);
+    ofs += n * sizeof(Input::Scalar);
+  }
+}
+
+bool Replay::Fetch()
+{
+  if (m_ofs == m_map_size) {
+    return false;
+  }
+  // A recording cut short, e.g. by a crash or SIGINT, ends with a partial
+  // event, treat that as the end.
+  auto left = m_map_size - m_ofs;
+  bool ok = left >= 8;
+  size_t bytes = 0;
+  if (ok) {
+    bytes = *Get(m_ofs);
+    ok = bytes <= left - 8;
+  }
+  auto ev_ofs = m_ofs + 8;
+  auto ofs = ev_ofs;
+  auto end = ev_ofs + bytes;
+  for (size_t i = 0; ok && i < m_binding_n; ++i) {
+    ok = end - ofs >= 8;
+    if (ok) {
+      auto n = *Get(ofs);
+      ofs += 8;
+      ok = n <= (end - ofs) / sizeof(Input::Scalar);
+      ofs += n * sizeof(Input::Scalar);
+    }
+  }
+  if (!ok) {
+    std::cerr << m_path << ": Truncated event at " << m_ofs <<
+        ", stopping.\n";
+    m_ofs = m_map_size;
+    return false;
+  }
+  m_ev_ofs = ev_ofs;
+  m_ofs = end;
+  return true;
+}
+
+uint64_t const *Replay::Get(size_t a_ofs)
+{
+  if (a_ofs + sizeof(uint64_t) > m_map_size) {
+    std::cerr << m_path << ": Truncated at " << a_ofs << ".\n";
+    throw std::runtime_error(__func__);
+  }
+  return (uint64_t const *)&m_map[a_ofs];
+}
+
+std::pair<Input::Scalar const *, size_t> Replay::GetData(unsigned a_slot,
+    size_t a_id)
+{
+  return m_slot_vec.at(a_slot).at(a_id);
+}
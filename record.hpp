@@ -0,0 +1,97 @@
+/*
+ * plutt, a scriptable monitor for experimental data.
+ *
+ * Copyright (C) 2023  Hans Toshihide Toernqvist <hans.tornqvist@chalmers.se>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301  USA
+ */
+
+#ifndef RECORD_HPP
+#define RECORD_HPP
+
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+#include <input.hpp>
+
+class Config;
+
+/*
+ * Record/replay of bound signals, so configs can be tuned without re-running
+ * the unpacker.
+ * File layout, all fields are 64-bit and everything is 8-byte aligned so the
+ * replay can hand out pointers straight into the mapping:
+ *  magic "PLUTTRC1",
+ *  # bindings,
+ *  per binding: type, name length, suffix length, name + suffix padded,
+ *  per event: # bytes to follow,
+ *   per binding: # scalars, scalars.
+ * The data is not compressed, that would rule out the zero-copy replay.
+ */
+
+/*
+ * Writes what the given input delivers for the bindings of the config.
+ */
+class Recorder {
+  public:
+    Recorder(Config const &, char const *);
+    ~Recorder();
+    // Call from the thread which owns the slot, after Input::Buffer.
+    void Write(Input *, unsigned);
+
+  private:
+    Recorder(Recorder const &);
+    Recorder &operator=(Recorder const &);
+    void Put(void const *, size_t);
+
+    std::string m_path;
+    FILE *m_file;
+    std::vector<size_t> m_id_vec;
+    std::vector<std::pair<Input::Scalar const *, size_t>> m_data_vec;
+};
+
+/*
+ * Replays a recording through mmap, GetData points into the mapping.
+ * The unsigned is the number of output slots, see input.hpp.
+ */
+class Replay: public Input {
+  public:
+    Replay(Config &, unsigned, char const *);
+    ~Replay();
+    void Buffer(unsigned);
+    bool Fetch();
+    std::pair<Input::Scalar const *, size_t> GetData(unsigned, size_t);
+
+  private:
+    Replay(Replay const &);
+    Replay &operator=(Replay const &);
+    void Bind(Config &);
+    uint64_t const *Get(size_t);
+
+    std::string m_path;
+    uint8_t const *m_map;
+    size_t m_map_size;
+    size_t m_binding_n;
+    // Offset of the next event, and of the fetched one.
+    size_t m_ofs;
+    size_t m_ev_ofs;
+    // Per slot and binding: scalars and their count.
+    std::vector<std::vector<std::pair<Input::Scalar const *, size_t>>>
+        m_slot_vec;
+};
+
+#endif
@@ -25,7 +25,10 @@
 
 #include <root.hpp>
 #include <sys/stat.h>
+#include <cassert>
+#include <cstring>
 #include <TChain.h>
+#include <TROOT.h>
 #include <TTreeReader.h>
 #include <TTreeReaderArray.h>
 #include <TTreeReaderValue.h>
@@ -34,15 +37,16 @@
 
 class RootImpl {
   public:
-    RootImpl(Config &, int, char **);
+    RootImpl(Config &, unsigned, int, char **, unsigned, unsigned);
     ~RootImpl();
-    void Buffer();
+    void Buffer(unsigned);
     bool Fetch();
-    std::pair<Input::Scalar const *, size_t> GetData(size_t);
+    std::pair<Input::Scalar const *, size_t> GetData(unsigned, size_t);
 
   private:
     void BindBranch(Config &, std::string const &, char const *, char const *,
-        bool);
+        bool, bool);
+    void Convert(unsigned, size_t);
 
     TChain m_chain;
     TTreeReader m_reader;
@@ -65,7 +69,9 @@ class RootImpl {
         arr_float(),
         val_double(),
         arr_double(),
-        buf()
+        raw(),
+        buf(),
+        gen()
       {
       }
       Entry(Entry const &a_e):
@@ -85,7 +91,9 @@ class RootImpl {
         arr_float(),
         val_double(),
         arr_double(),
-        buf()
+        raw(),
+        buf(),
+        gen()
       {
         Copy(a_e);
       }
@@ -110,7 +118,11 @@ class RootImpl {
       TTreeReaderArray<Float_t> *arr_float;
       TTreeReaderValue<Double_t> *val_double;
       TTreeReaderArray<Double_t> *arr_double;
-      Vector<Input::Scalar> buf;
+      // Per slot: raw copy of the reader data, converted buffer, and the
+      // event generation buf was converted for.
+      Vector<uint8_t> *raw;
+      Vector<Input::Scalar> *buf;
+      uint64_t *gen;
       private:
       void Copy(Entry const &a_e)
       {
@@ -136,23 +148,35 @@ class RootImpl {
         arr_float = a_e.arr_float;
         val_double = a_e.val_double;
         arr_double = a_e.arr_double;
+        raw = a_e.raw;
+        buf = a_e.buf;
+        gen = a_e.gen;
       }
     };
+    unsigned m_slot_num;
     std::vector<Entry> m_branch_vec;
+    std::vector<uint64_t> m_slot_gen;
+    Long64_t m_cache_size;
     Long64_t m_ev_n;
     Long64_t m_ev_i;
     Long64_t m_ev_i_latch;
     uint64_t m_progress_t_last;
+    unsigned m_part_i;
 };
 
-RootImpl::RootImpl(Config &a_config, int a_argc, char **a_argv):
+RootImpl::RootImpl(Config &a_config, unsigned a_slot_num, int a_argc, char
+    **a_argv, unsigned a_part_i, unsigned a_part_n):
   m_chain(a_argv[0]),
   m_reader(&m_chain),
+  m_slot_num(a_slot_num),
   m_branch_vec(),
+  m_slot_gen(a_slot_num),
+  m_cache_size(),
   m_ev_n(),
   m_ev_i(),
   m_ev_i_latch(),
-  m_progress_t_last()
+  m_progress_t_last(),
+  m_part_i(a_part_i)
 {
   auto signal_list = a_config.GetSignalList();
 
@@ -166,17 +190,41 @@ RootImpl::RootImpl(Config &a_config, int a_argc, char **a_argv):
     m_chain.Add(a_argv[i]);
   }
   m_ev_n = m_chain.GetEntries();
+  Long64_t ev_begin = 0;
+  Long64_t ev_end = m_ev_n;
+  if (a_part_n > 1) {
+    auto begin = m_ev_n * a_part_i / a_part_n;
+    auto end = m_ev_n * (a_part_i + 1) / a_part_n;
+    if (TTreeReader::kEntryValid != m_reader.SetEntriesRange(begin, end)) {
+      std::cerr << a_argv[0] << ": Could not set entry range " << begin <<
+          ".." << end << ".\n";
+      throw std::runtime_error(__func__);
+    }
+    m_ev_n = end - begin;
+    ev_begin = begin;
+    ev_end = end;
+  }
 
   // Look for branches for each signal.
+  auto do_bind = 0 == a_part_i;
   for (auto it = signal_list.begin(); signal_list.end() != it; ++it) {
-    BindBranch(a_config, *it,   "",   "", false);
-    BindBranch(a_config, *it,  "M",  "M", true);
-    BindBranch(a_config, *it,  "I",  "I", true);
-    BindBranch(a_config, *it, "MI", "MI", true);
-    BindBranch(a_config, *it, "ME", "ME", true);
-    BindBranch(a_config, *it,  "v",  "v", true);
-    BindBranch(a_config, *it,  "E",  "v", true);
+    BindBranch(a_config, *it,   "",   "", false, do_bind);
+    BindBranch(a_config, *it,  "M",  "M", true,  do_bind);
+    BindBranch(a_config, *it,  "I",  "I", true,  do_bind);
+    BindBranch(a_config, *it, "MI", "MI", true,  do_bind);
+    BindBranch(a_config, *it, "ME", "ME", true,  do_bind);
+    BindBranch(a_config, *it,  "v",  "v", true,  do_bind);
+    BindBranch(a_config, *it,  "E",  "v", true,  do_bind);
+  }
+
+  // Cache only the bound branches, room for one basket of each, so whole
+  // baskets are read in bulk rather than as the readers touch them.
+  m_chain.SetCacheSize(m_cache_size);
+  for (auto it = m_branch_vec.begin(); m_branch_vec.end() != it; ++it) {
+    m_chain.AddBranchToCache(it->name.c_str(), true);
   }
+  m_chain.StopCacheLearningPhase();
+  m_chain.SetCacheEntryRange(ev_begin, ev_end);
 }
 
 RootImpl::~RootImpl()
@@ -194,11 +242,15 @@ RootImpl::~RootImpl()
     delete it->arr_float;
     delete it->val_double;
     delete it->arr_double;
+    delete [] it->raw;
+    delete [] it->buf;
+    delete [] it->gen;
   }
 }
 
 void RootImpl::BindBranch(Config &a_config, std::string const &a_name, char
-    const *a_suffix, char const *a_config_suffix, bool a_optional)
+    const *a_suffix, char const *a_config_suffix, bool a_optional, bool
+    a_do_bind)
 {
   // full = name + suffix
   // If full = "m*", then GetBranch("m*").GetTitle() = "m*".
@@ -252,10 +304,15 @@ void RootImpl::BindBranch(Config &a_config, std::string const &a_name, char
       throw std::runtime_error(__func__);
   }
 
+  m_cache_size += branch->GetBasketSize();
+
   auto id = m_branch_vec.size();
   m_branch_vec.push_back(RootImpl::Entry(full_name, exp_type, out_type,
         is_vector));
   auto &entry = m_branch_vec.back();
+  entry.raw = new Vector<uint8_t>[m_slot_num];
+  entry.buf = new Vector<Input::Scalar>[m_slot_num];
+  entry.gen = new uint64_t[m_slot_num]();
 
   // Reader instantiation ladder.
   switch (exp_type) {
@@ -282,34 +339,41 @@ void RootImpl::BindBranch(Config &a_config, std::string const &a_name, char
       throw std::runtime_error(__func__);
   }
 
-  a_config.BindSignal(a_name, a_config_suffix, id, out_type);
+  if (a_do_bind) {
+    a_config.BindSignal(a_name, a_config_suffix, id, out_type);
+  }
 }
 
-void RootImpl::Buffer()
+void RootImpl::Buffer(unsigned a_slot)
 {
-  // Copy from readers to vectors.
+  assert(a_slot < m_slot_num);
+  // The readers only hold the current entry, so keep a raw copy of every
+  // branch, conversion waits for GetData.
+  ++m_slot_gen[a_slot];
   for (auto it = m_branch_vec.begin(); m_branch_vec.end() != it; ++it) {
+    auto &raw = it->raw[a_slot];
     // TODO: Error-checking!
     switch (it->in_type) {
-#define BUF_COPY_TYPE(root_type, reader_type, s_type) \
+#define BUF_RAW_TYPE(root_type, c_type, reader_type) \
       case root_type: \
         if (it->is_vector) { \
           auto const size = it->arr_##reader_type->GetSize(); \
-          it->buf.resize(size); \
-          for (size_t i = 0; i < size; ++i) { \
-            it->buf[i].s_type = it->arr_##reader_type->At(i); \
+          raw.resize(size * sizeof(c_type)); \
+          if (size > 0) { \
+            memcpy(&raw[0], &it->arr_##reader_type->At(0), \
+                size * sizeof(c_type)); \
           } \
         } else { \
-          it->buf.resize(1); \
-          it->buf[0].s_type = **it->val_##reader_type; \
+          raw.resize(sizeof(c_type)); \
+          memcpy(&raw[0], &**it->val_##reader_type, sizeof(c_type)); \
         } \
         break
-      BUF_COPY_TYPE(kUChar_t,  uchar,  u64);
-      BUF_COPY_TYPE(kUShort_t, ushort, u64);
-      BUF_COPY_TYPE(kUInt_t,   uint,   u64);
-      BUF_COPY_TYPE(kULong_t,  ulong,  u64);
-      BUF_COPY_TYPE(kFloat_t,  float,  dbl);
-      BUF_COPY_TYPE(kDouble_t, double, dbl);
+      BUF_RAW_TYPE(kUChar_t,  UChar_t,  uchar);
+      BUF_RAW_TYPE(kUShort_t, UShort_t, ushort);
+      BUF_RAW_TYPE(kUInt_t,   UInt_t,   uint);
+      BUF_RAW_TYPE(kULong_t,  ULong_t,  ulong);
+      BUF_RAW_TYPE(kFloat_t,  float,    float);
+      BUF_RAW_TYPE(kDouble_t, double,   double);
       default:
         std::cerr << it->name << ": Non-implemented input type.\n";
         throw std::runtime_error(__func__);
@@ -317,15 +381,49 @@ void RootImpl::Buffer()
   }
 }
 
+void RootImpl::Convert(unsigned a_slot, size_t a_id)
+{
+  auto &entry = m_branch_vec.at(a_id);
+  auto const &raw = entry.raw[a_slot];
+  auto &buf = entry.buf[a_slot];
+  switch (entry.in_type) {
+  // Plain pointer loops, so the compiler can vectorize the widening.
+#define BUF_COPY_TYPE(root_type, c_type, s_type) \
+    case root_type: \
+      { \
+        auto const size = raw.size() / sizeof(c_type); \
+        buf.resize(size); \
+        if (size > 0) { \
+          auto p = (c_type const *)raw.begin(); \
+          auto out = &buf.front(); \
+          for (size_t i = 0; i < size; ++i) { \
+            out[i].s_type = p[i]; \
+          } \
+        } \
+      } \
+      break
+    BUF_COPY_TYPE(kUChar_t,  UChar_t,  u64);
+    BUF_COPY_TYPE(kUShort_t, UShort_t, u64);
+    BUF_COPY_TYPE(kUInt_t,   UInt_t,   u64);
+    BUF_COPY_TYPE(kULong_t,  ULong_t,  u64);
+    BUF_COPY_TYPE(kFloat_t,  float,    dbl);
+    BUF_COPY_TYPE(kDouble_t, double,   dbl);
+    default:
+      std::cerr << entry.name << ": Non-implemented input type.\n";
+      throw std::runtime_error(__func__);
+  }
+  entry.gen[a_slot] = m_slot_gen[a_slot];
+}
+
 bool RootImpl::Fetch()
 {
   if (!m_reader.Next()) {
     return false;
   }
 
-  // Progress meter.
-  if (Time_get_ms() > m_progress_t_last + 1000 ||
-      m_ev_i + 1 == m_ev_n) {
+  // Progress meter, only the first partition prints its share.
+  if (0 == m_part_i && (Time_get_ms() > m_progress_t_last + 1000 ||
+      m_ev_i + 1 == m_ev_n)) {
     auto rate = m_ev_i - m_ev_i_latch;
     std::string prefix = "";
     if (rate > 1000) {
@@ -344,21 +442,35 @@ bool RootImpl::Fetch()
   return true;
 }
 
-std::pair<Input::Scalar const *, size_t> RootImpl::GetData(size_t a_id)
+std::pair<Input::Scalar const *, size_t> RootImpl::GetData(unsigned a_slot,
+    size_t a_id)
 {
+  assert(a_slot < m_slot_num);
   auto const &entry = m_branch_vec.at(a_id);
+  if (entry.gen[a_slot] != m_slot_gen[a_slot]) {
+    Convert(a_slot, a_id);
+  }
+  auto const &buf = entry.buf[a_slot];
   if (entry.is_vector) {
-    if (entry.buf.empty()) {
+    if (buf.empty()) {
       return std::make_pair(nullptr, 0);
     }
-    return std::make_pair(&entry.buf.at(0), entry.buf.size());
+    return std::make_pair(&buf.at(0), buf.size());
   }
-  return std::make_pair(&entry.buf.at(0), 1);
+  return std::make_pair(&buf.at(0), 1);
 }
 
-Root::Root(Config &a_config, int a_argc, char **a_argv):
-  m_impl(new RootImpl(a_config, a_argc, a_argv))
+Root::Root(Config &a_config, unsigned a_slot_num, int a_argc, char
+    **a_argv, unsigned a_part_i, unsigned a_part_n):
+  m_impl()
 {
+  if (a_part_n > 1) {
+    // Parts open and read their chains on separate input threads, which
+    // touches gROOT and gDirectory.
+    ROOT::EnableThreadSafety();
+  }
+  m_impl = new RootImpl(a_config, a_slot_num, a_argc, a_argv, a_part_i,
+      a_part_n);
 }
 
 Root::~Root()
@@ -366,9 +478,9 @@ Root::~Root()
   delete m_impl;
 }
 
-void Root::Buffer()
+void Root::Buffer(unsigned a_slot)
 {
-  m_impl->Buffer();
+  m_impl->Buffer(a_slot);
 }
 
 bool Root::Fetch()
@@ -376,9 +488,10 @@ bool Root::Fetch()
   return m_impl->Fetch();
 }
 
-std::pair<Input::Scalar const *, size_t> Root::GetData(size_t a_id)
+std::pair<Input::Scalar const *, size_t> Root::GetData(unsigned a_slot,
+    size_t a_id)
 {
-  return m_impl->GetData(a_id);
+  return m_impl->GetData(a_slot, a_id);
 }
 
 #endif
@@ -33,14 +33,18 @@ class RootImpl;
 /*
  * Root input.
  * Takes argc/argv after main arguments and hopes they are all Root files.
+ * The first unsigned is the number of output slots, see input.hpp.
+ * The last two select partition i of n, i.e. that share of the chain's
+ * entries, so several readers can run in parallel. Only partition 0 binds
+ * signals to the config, the others have the same IDs.
  */
 class Root: public Input {
   public:
-    Root(Config &, int, char **);
+    Root(Config &, unsigned, int, char **, unsigned = 0, unsigned = 1);
     ~Root();
-    void Buffer();
+    void Buffer(unsigned);
     bool Fetch();
-    std::pair<Input::Scalar const *, size_t> GetData(size_t);
+    std::pair<Input::Scalar const *, size_t> GetData(unsigned, size_t);
 
   private:
     Root(Root const &);
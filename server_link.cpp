@@ -0,0 +1,65 @@
+/*
+ * plutt, a scriptable monitor for experimental data.
+ *
+ * Copyright (C) 2023  Hans Toshihide Toernqvist <hans.tornqvist@chalmers.se>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301  USA
+ */
+
+#include <server_link.hpp>
+#include <iostream>
+
+ServerLink::ServerLink(std::string const &a_name, Client *a_client, unsigned
+    a_try_n):
+  m_name(a_name),
+  m_client(a_client),
+  m_try_n(a_try_n)
+{
+}
+
+bool ServerLink::Connect()
+{
+  for (unsigned i = 0; i < m_try_n; ++i) {
+    if (0 != i && !m_client->Pause()) {
+      break;
+    }
+    std::cout << m_name << ": Connecting (" << i + 1 << '/' << m_try_n <<
+        ")...\n";
+    if (m_client->Connect()) {
+      std::cout << m_name << ": Connected.\n";
+      return true;
+    }
+  }
+  std::cerr << m_name << ": Giving up.\n";
+  return false;
+}
+
+bool ServerLink::Fetch(std::vector<uint8_t> *a_buf)
+{
+  for (;;) {
+    auto ret = m_client->Fetch(a_buf);
+    if (0 != ret && -1 != ret) {
+      return true;
+    }
+    // A server going away is a restart rather than the end of data, the
+    // partial event is dropped and the new connection starts on a whole
+    // one.
+    std::cerr << m_name << ": Lost server.\n";
+    if (!Connect()) {
+      return false;
+    }
+  }
+}
@@ -0,0 +1,65 @@
+/*
+ * plutt, a scriptable monitor for experimental data.
+ *
+ * Copyright (C) 2023  Hans Toshihide Toernqvist <hans.tornqvist@chalmers.se>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301  USA
+ */
+
+#ifndef SERVER_LINK_HPP
+#define SERVER_LINK_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * Keeps an event stream from a server going over server restarts, so the
+ * struct-server input can treat a lost server as a pause rather than the
+ * end of data. The connection itself is behind Client, see Unpacker.
+ */
+class ServerLink {
+  public:
+    class Client {
+      public:
+        virtual ~Client() {}
+        // Sets up a fresh connection, false if the server is not there.
+        virtual bool Connect() = 0;
+        // Fetches an event into the buffer, as ext_data_clnt::fetch_event:
+        // 0 at the end and -1 on errors, which both mean a lost server.
+        virtual int Fetch(std::vector<uint8_t> *) = 0;
+        // Waits between tries, false to give up trying.
+        virtual bool Pause() = 0;
+    };
+
+    ServerLink(std::string const &, Client *, unsigned);
+    // Tries to connect up to the given number of times, with a pause
+    // between tries.
+    bool Connect();
+    // Fetches the next event, dropping whatever a lost server left in the
+    // buffer and reconnecting. False when reconnecting gives up.
+    bool Fetch(std::vector<uint8_t> *);
+
+  private:
+    ServerLink(ServerLink const &);
+    ServerLink &operator=(ServerLink const &);
+
+    std::string m_name;
+    Client *m_client;
+    unsigned m_try_n;
+};
+
+#endif
@@ -0,0 +1,330 @@
+/*
+ * plutt, a scriptable monitor for experimental data.
+ *
+ * Copyright (C) 2023  Hans Toshihide Toernqvist <hans.tornqvist@chalmers.se>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301  USA
+ */
+
+#include <shm_ring.hpp>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <set>
+#include <stdexcept>
+#include <config.hpp>
+
+#define SHM_RING_LOAD(p) __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define SHM_RING_STORE(p, v) __atomic_store_n(p, v, __ATOMIC_RELEASE)
+
+namespace {
+
+  size_t SlotsOfs(uint64_t a_member_n)
+  {
+    return sizeof(ShmRingHeader) + a_member_n * sizeof(ShmRingMember);
+  }
+
+}
+
+ShmRing::ShmRing(Config &a_config, unsigned a_slot_num, char const *a_name):
+  m_name(a_name),
+  m_map(),
+  m_map_size(),
+  m_header(),
+  m_member(),
+  m_slot0(),
+  m_read_n(),
+  m_lapped_n(),
+  m_stop(),
+  m_bound_vec(),
+  m_fetch_buf(),
+  m_slot_buf_vec(a_slot_num)
+{
+  auto fd = shm_open(a_name, O_RDONLY, 0);
+  if (-1 == fd) {
+    perror("shm_open");
+    std::cerr << a_name << ": Could not open shm ring.\n";
+    throw std::runtime_error(__func__);
+  }
+  struct stat st;
+  if (-1 == fstat(fd, &st)) {
+    perror("fstat");
+    close(fd);
+    throw std::runtime_error(__func__);
+  }
+  m_map_size = (size_t)st.st_size;
+  if (m_map_size < sizeof(ShmRingHeader)) {
+    std::cerr << a_name << ": Not a shm ring.\n";
+    close(fd);
+    throw std::runtime_error(__func__);
+  }
+  m_map = mmap(nullptr, m_map_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (MAP_FAILED == m_map) {
+    perror("mmap");
+    throw std::runtime_error(__func__);
+  }
+  try {
+    Bind(a_config);
+  } catch (...) {
+    // The destructor will not run for a half-built object.
+    munmap(m_map, m_map_size);
+    throw;
+  }
+
+  // Start with what the producer has now.
+  m_read_n = SHM_RING_LOAD(&m_header->write_n);
+  std::cout << a_name << ": Attached at event " << m_read_n << ".\n";
+}
+
+ShmRing::~ShmRing()
+{
+  if (0 != m_lapped_n) {
+    std::cout << m_name << ": " << m_lapped_n <<
+        " events lapped by the producer.\n";
+  }
+  munmap(m_map, m_map_size);
+}
+
+void ShmRing::Bind(Config &a_config)
+{
+  m_header = (ShmRingHeader const *)m_map;
+  if (0 != memcmp(m_header->magic, SHM_RING_MAGIC, 8)) {
+    std::cerr << m_name << ": Not a shm ring.\n";
+    throw std::runtime_error(__func__);
+  }
+  auto slots_ofs = SlotsOfs(m_header->member_n);
+  if (0 == m_header->slot_n ||
+      slots_ofs + m_header->slot_n * m_header->slot_bytes > m_map_size) {
+    std::cerr << m_name << ": Ring larger than segment.\n";
+    throw std::runtime_error(__func__);
+  }
+  m_member = (ShmRingMember const *)(m_header + 1);
+  m_slot0 = (uint8_t const *)m_map + slots_ofs;
+
+  // Bind the members of the signals the config wants, by member index.
+  auto signal_list = a_config.GetSignalList();
+  std::set<std::string> signal_set(signal_list.begin(), signal_list.end());
+  std::set<std::string> bound_set;
+  for (uint64_t i = 0; i < m_header->member_n; ++i) {
+    auto const &member = m_member[i];
+    if (member.ofs < sizeof(uint64_t) || member.ofs + sizeof(uint64_t) *
+        (1 + member.max_len) > m_header->slot_bytes) {
+      std::cerr << m_name << ": Member " << i << " outside slot.\n";
+      throw std::runtime_error(__func__);
+    }
+    std::string name(member.name, strnlen(member.name, sizeof member.name));
+    std::string suffix(member.suffix, strnlen(member.suffix,
+        sizeof member.suffix));
+    if (signal_set.count(name)) {
+      a_config.BindSignal(name, suffix.c_str(), i, (Input::Type)member.type);
+      bound_set.insert(name);
+      m_bound_vec.push_back(i);
+    }
+  }
+  for (auto it = signal_set.begin(); signal_set.end() != it; ++it) {
+    if (!bound_set.count(*it)) {
+      std::cerr << *it << ": Signal not in shm ring.\n";
+      throw std::runtime_error(__func__);
+    }
+  }
+
+  auto word_n = m_header->slot_bytes / sizeof(uint64_t);
+  m_fetch_buf.resize(word_n);
+  for (auto it = m_slot_buf_vec.begin(); m_slot_buf_vec.end() != it; ++it) {
+    it->resize(word_n);
+  }
+}
+
+void ShmRing::Buffer(unsigned a_slot)
+{
+  m_slot_buf_vec.at(a_slot).swap(m_fetch_buf);
+}
+
+bool ShmRing::Fetch()
+{
+  auto slot_n = m_header->slot_n;
+  for (;;) {
+    auto write_n = SHM_RING_LOAD(&m_header->write_n);
+    if (m_read_n == write_n) {
+      // write_n is set before is_done, so check it again.
+      if (SHM_RING_LOAD(&m_header->is_done) &&
+          SHM_RING_LOAD(&m_header->write_n) == m_read_n) {
+        return false;
+      }
+      // A stalled producer must not keep us from quitting.
+      if (SHM_RING_LOAD(&m_stop)) {
+        return false;
+      }
+      struct timespec ts = {0, 100000};
+      nanosleep(&ts, nullptr);
+      continue;
+    }
+    if (write_n - m_read_n > slot_n) {
+      auto skip = write_n - slot_n - m_read_n;
+      m_lapped_n += skip;
+      m_read_n += skip;
+    }
+    // The producer may have moved on since write_n was loaded, and may
+    // lap the slot while we copy, so check the sequence before and after.
+    auto slot = m_slot0 + (m_read_n % slot_n) * m_header->slot_bytes;
+    auto seq = (uint64_t const *)slot;
+    auto seq_ok = 2 * m_read_n + 2;
+    if (seq_ok == SHM_RING_LOAD(seq)) {
+      auto dst = (uint8_t *)m_fetch_buf.data();
+      for (auto it = m_bound_vec.begin(); m_bound_vec.end() != it; ++it) {
+        auto const &member = m_member[*it];
+        auto n = std::min(*(uint64_t const *)(slot + member.ofs),
+            member.max_len);
+        *(uint64_t *)(dst + member.ofs) = n;
+        memcpy(dst + member.ofs + sizeof(uint64_t),
+            slot + member.ofs + sizeof(uint64_t), n * sizeof(uint64_t));
+      }
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      if (seq_ok == __atomic_load_n(seq, __ATOMIC_RELAXED)) {
+        ++m_read_n;
+        return true;
+      }
+    }
+    ++m_lapped_n;
+    ++m_read_n;
+  }
+}
+
+std::pair<Input::Scalar const *, size_t> ShmRing::GetData(unsigned a_slot,
+    size_t a_id)
+{
+  if (a_id >= m_header->member_n) {
+    std::cerr << m_name << ": Member " << a_id << " out of range.\n";
+    throw std::runtime_error(__func__);
+  }
+  auto p = (uint8_t const *)m_slot_buf_vec.at(a_slot).data() +
+      m_member[a_id].ofs;
+  return std::make_pair((Input::Scalar const *)(p + sizeof(uint64_t)),
+      *(uint64_t const *)p);
+}
+
+void ShmRing::Stop()
+{
+  SHM_RING_STORE(&m_stop, true);
+}
+
+ShmRingWriter::ShmRingWriter(char const *a_name, std::vector<ShmRingMember>
+    const &a_member_vec, uint64_t a_slot_n):
+  m_name(a_name),
+  m_map(),
+  m_map_size(),
+  m_header(),
+  m_member(),
+  m_slot(),
+  m_event_i()
+{
+  uint64_t slot_bytes = sizeof(uint64_t);
+  for (auto it = a_member_vec.begin(); a_member_vec.end() != it; ++it) {
+    slot_bytes += sizeof(uint64_t) * (1 + it->max_len);
+  }
+  m_map_size = SlotsOfs(a_member_vec.size()) + a_slot_n * slot_bytes;
+
+  auto fd = shm_open(a_name, O_CREAT | O_TRUNC | O_RDWR, 0644);
+  if (-1 == fd) {
+    perror("shm_open");
+    std::cerr << a_name << ": Could not create shm ring.\n";
+    throw std::runtime_error(__func__);
+  }
+  if (-1 == ftruncate(fd, (off_t)m_map_size)) {
+    perror("ftruncate");
+    close(fd);
+    shm_unlink(a_name);
+    throw std::runtime_error(__func__);
+  }
+  m_map = mmap(nullptr, m_map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+      0);
+  close(fd);
+  if (MAP_FAILED == m_map) {
+    perror("mmap");
+    shm_unlink(a_name);
+    throw std::runtime_error(__func__);
+  }
+
+  m_header = (ShmRingHeader *)m_map;
+  m_member = (ShmRingMember *)(m_header + 1);
+  m_slot = (uint8_t *)m_map + SlotsOfs(a_member_vec.size());
+  m_header->member_n = a_member_vec.size();
+  m_header->slot_n = a_slot_n;
+  m_header->slot_bytes = slot_bytes;
+  uint64_t ofs = sizeof(uint64_t);
+  for (size_t i = 0; i < a_member_vec.size(); ++i) {
+    m_member[i] = a_member_vec[i];
+    m_member[i].ofs = ofs;
+    ofs += sizeof(uint64_t) * (1 + m_member[i].max_len);
+  }
+  // Magic last, a consumer cannot attach to a half-made ring.
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  memcpy(m_header->magic, SHM_RING_MAGIC, 8);
+}
+
+ShmRingWriter::~ShmRingWriter()
+{
+  Done();
+  munmap(m_map, m_map_size);
+  shm_unlink(m_name.c_str());
+}
+
+void ShmRingWriter::Begin()
+{
+  auto seq = (uint64_t *)(m_slot + (m_event_i % m_header->slot_n) *
+      m_header->slot_bytes);
+  __atomic_store_n(seq, 2 * m_event_i + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+void ShmRingWriter::Commit()
+{
+  auto seq = (uint64_t *)(m_slot + (m_event_i % m_header->slot_n) *
+      m_header->slot_bytes);
+  ++m_event_i;
+  SHM_RING_STORE(seq, 2 * m_event_i);
+  SHM_RING_STORE(&m_header->write_n, m_event_i);
+}
+
+Input::Scalar *ShmRingWriter::Data(size_t a_member_i)
+{
+  auto slot = m_slot + (m_event_i % m_header->slot_n) * m_header->slot_bytes;
+  return (Input::Scalar *)(slot + m_member[a_member_i].ofs +
+      sizeof(uint64_t));
+}
+
+void ShmRingWriter::Done()
+{
+  SHM_RING_STORE(&m_header->is_done, 1);
+}
+
+void ShmRingWriter::SetLen(size_t a_member_i, size_t a_n)
+{
+  auto const &member = m_member[a_member_i];
+  if (a_n > member.max_len) {
+    std::cerr << member.name << ": " << a_n << " > max " << member.max_len <<
+        ".\n";
+    throw std::runtime_error(__func__);
+  }
+  auto slot = m_slot + (m_event_i % m_header->slot_n) * m_header->slot_bytes;
+  *(uint64_t *)(slot + member.ofs) = a_n;
+}
@@ -0,0 +1,138 @@
+/*
+ * plutt, a scriptable monitor for experimental data.
+ *
+ * Copyright (C) 2023  Hans Toshihide Toernqvist <hans.tornqvist@chalmers.se>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301  USA
+ */
+
+#ifndef SHM_RING_HPP
+#define SHM_RING_HPP
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include <input.hpp>
+
+class Config;
+
+/*
+ * POSIX shared-memory ring of fixed-layout events, for producers on the
+ * same host. The segment is laid out as, all fields 64-bit:
+ *  ShmRingHeader,
+ *  ShmRingMember * member_n,
+ *  slot_n slots of slot_bytes each, every slot being:
+ *   sequence word,
+ *   per member at ShmRingMember::ofs from the slot start: # scalars, then
+ *   max_len Input::Scalar:s.
+ * Event e goes into slot e % slot_n. The producer sets the sequence word to
+ * 2e+1, writes the data in place, sets it to 2e+2 and then write_n to e+1,
+ * with release semantics. The consumer only reads, so it can never block
+ * the producer, and events lapped by the producer are skipped.
+ * ShmRingWriter implements the producer side.
+ */
+
+#define SHM_RING_MAGIC "PLUTTSR1"
+
+struct ShmRingHeader {
+  char magic[8];
+  uint64_t member_n;
+  uint64_t slot_n;
+  uint64_t slot_bytes;
+  // Written by the producer: # committed events, and non-zero once done.
+  uint64_t write_n;
+  uint64_t is_done;
+};
+
+struct ShmRingMember {
+  // Signal name and member suffix, eg "v" or "" for scalars, see
+  // Config::BindSignal, 0-terminated.
+  char name[48];
+  char suffix[8];
+  uint64_t type;
+  uint64_t max_len;
+  uint64_t ofs;
+};
+
+/*
+ * Consumer, Fetch copies the bound members of an event out of the ring and
+ * checks the sequence word after the copy, so an event the producer lapped
+ * meanwhile is skipped whole. Buffer hands the copy to the slot.
+ * The unsigned is the number of output slots, see input.hpp.
+ */
+class ShmRing: public Input {
+  public:
+    ShmRing(Config &, unsigned, char const *);
+    ~ShmRing();
+    void Buffer(unsigned);
+    bool Fetch();
+    std::pair<Input::Scalar const *, size_t> GetData(unsigned, size_t);
+    void Stop();
+
+  private:
+    ShmRing(ShmRing const &);
+    ShmRing &operator=(ShmRing const &);
+    void Bind(Config &);
+
+    std::string m_name;
+    void *m_map;
+    size_t m_map_size;
+    ShmRingHeader const *m_header;
+    ShmRingMember const *m_member;
+    uint8_t const *m_slot0;
+    uint64_t m_read_n;
+    uint64_t m_lapped_n;
+    // Set by Stop from another thread, atomic like the ring words.
+    bool m_stop;
+    // Members to copy.
+    std::vector<size_t> m_bound_vec;
+    // Copies laid out like a ring slot, of the fetched event and per slot.
+    std::vector<uint64_t> m_fetch_buf;
+    std::vector<std::vector<uint64_t>> m_slot_buf_vec;
+};
+
+/*
+ * Producer, creates the ring and unlinks it when destroyed:
+ *  Begin(), fill Data(i) and SetLen(i) for every member, Commit().
+ * Members are given without ofs, which is filled in.
+ */
+class ShmRingWriter {
+  public:
+    ShmRingWriter(char const *, std::vector<ShmRingMember> const &,
+        uint64_t);
+    ~ShmRingWriter();
+    void Begin();
+    Input::Scalar *Data(size_t);
+    void SetLen(size_t, size_t);
+    void Commit();
+    // Tells the consumer there will be no more events.
+    void Done();
+
+  private:
+    ShmRingWriter(ShmRingWriter const &);
+    ShmRingWriter &operator=(ShmRingWriter const &);
+
+    std::string m_name;
+    void *m_map;
+    size_t m_map_size;
+    ShmRingHeader *m_header;
+    ShmRingMember *m_member;
+    uint8_t *m_slot;
+    uint64_t m_event_i;
+};
+
+#endif
@@ -0,0 +1,43 @@
+/*
+ * plutt, a scriptable monitor for experimental data.
+ *
+ * Copyright (C) 2023  Hans Toshihide Toernqvist <hans.tornqvist@chalmers.se>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301  USA
+ */
+
+#ifndef MOCK_INPUT_HPP
+#define MOCK_INPUT_HPP
+
+#include <vector>
+#include <input.hpp>
+
+// Serves the same per-member scalars for every slot and event.
+class MockInput: public Input {
+  public:
+    MockInput(): m_vec() {}
+    void Buffer(unsigned) {}
+    bool Fetch() { return true; }
+    std::pair<Input::Scalar const *, size_t> GetData(unsigned, size_t a_id)
+    {
+      auto const &v = m_vec.at(a_id);
+      return std::make_pair(v.data(), v.size());
+    }
+
+    std::vector<std::vector<Input::Scalar>> m_vec;
+};
+
+#endif
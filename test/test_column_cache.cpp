@@ -0,0 +1,127 @@
+/*
+ * plutt, a scriptable monitor for experimental data.
+ *
+ * Copyright (C) 2023  Hans Toshihide Toernqvist <hans.tornqvist@chalmers.se>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301  USA
+ */
+
+#include <test/test.hpp>
+#include <unistd.h>
+#include <cstdio>
+#include <column_cache.hpp>
+#include <config.hpp>
+#include <test/mock_input.hpp>
+
+#define DIRNAME "plutt_test_.cache"
+#define PLUTT_A "test/test_column_cache_a.plutt"
+#define PLUTT_AB "test/test_column_cache_ab.plutt"
+
+namespace {
+
+class MyTest: public Test {
+  void Run();
+};
+MyTest g_test_column_cache_;
+
+// Event i has i+1 values of "a" = 10*i+j, and i values of "b" = i.
+void Fill(MockInput *a_input, unsigned a_i)
+{
+  a_input->m_vec.clear();
+  a_input->m_vec.resize(2);
+  Input::Scalar s;
+  for (unsigned j = 0; j <= a_i; ++j) {
+    s.u64 = 10 * a_i + j;
+    a_input->m_vec[0].push_back(s);
+  }
+  for (unsigned j = 0; j < a_i; ++j) {
+    s.dbl = a_i;
+    a_input->m_vec[1].push_back(s);
+  }
+}
+
+// Runs a pass over "a" and maybe "b", committed if the input is drained.
+void Pass(bool a_has_b, unsigned a_event_n, bool a_is_drained)
+{
+  Config config(a_has_b ? PLUTT_AB : PLUTT_A, nullptr);
+  config.BindSignal("a", "", 0, Input::kUint64);
+  if (a_has_b) {
+    config.BindSignal("b", "v", 1, Input::kDouble);
+  }
+  ColumnCacheWriter writer(config, DIRNAME);
+  MockInput input;
+  for (unsigned i = 0; i < a_event_n; ++i) {
+    Fill(&input, i);
+    writer.Write(&input, 0);
+  }
+  if (a_is_drained) {
+    writer.Commit();
+  }
+}
+
+void MyTest::Run()
+{
+  // Cache "a", then fail to add "b" twice: once for an interrupted pass and
+  // once for a pass with another number of events.
+  Pass(false, 5, true);
+  Pass(true, 5, false);
+  Pass(true, 4, true);
+  {
+    Config config(PLUTT_A, nullptr);
+    TEST_BOOL(ColumnCache::Covers(config, DIRNAME));
+  }
+  {
+    Config config(PLUTT_AB, nullptr);
+    TEST_BOOL(!ColumnCache::Covers(config, DIRNAME));
+  }
+  Pass(true, 5, true);
+
+  // Read both into two slots.
+  {
+    Config config(PLUTT_AB, nullptr);
+    TEST_BOOL(ColumnCache::Covers(config, DIRNAME));
+    ColumnCache cache(config, 2, DIRNAME);
+    auto const &binding_vec = config.GetBindingVec();
+    TEST_CMP(binding_vec.size(), ==, 2U);
+    size_t a_id = binding_vec[0].name == "a" ? binding_vec[0].id :
+        binding_vec[1].id;
+    size_t b_id = 1 - a_id;
+    for (unsigned i = 0; i < 5; ++i) {
+      TEST_BOOL(cache.Fetch());
+      cache.Buffer(i % 2);
+      auto a = cache.GetData(i % 2, a_id);
+      TEST_CMP(a.second, ==, i + 1);
+      for (unsigned j = 0; j < a.second; ++j) {
+        TEST_CMP(a.first[j].u64, ==, 10 * i + j);
+      }
+      auto b = cache.GetData(i % 2, b_id);
+      TEST_CMP(b.second, ==, i);
+      for (unsigned j = 0; j < b.second; ++j) {
+        TEST_CMP(b.first[j].dbl, ==, i);
+      }
+    }
+    TEST_BOOL(!cache.Fetch());
+  }
+
+  // Failed passes must not leave anything behind.
+  unlink(DIRNAME "/a.dat");
+  unlink(DIRNAME "/a.ofs");
+  unlink(DIRNAME "/b.v.dat");
+  unlink(DIRNAME "/b.v.ofs");
+  TEST_CMP(rmdir(DIRNAME), ==, 0);
+}
+
+}
@@ -23,6 +23,8 @@
 #include <node_coarse_fine.hpp>
 #include <test/mock_node.hpp>
 
+#define PERIOD 10.0
+
 namespace {
 
 class MyTest: public Test {
@@ -52,6 +54,37 @@ void ProcessExtraFine(MockNodeValue &a_nv)
   a_nv.m_value[0].Push(1, s);
 }
 
+// Runs 20 events, the first 10 give the coarse time and the next 10 a
+// calibrated fine time.
+void Check20(NodeCoarseFine &a_n)
+{
+  auto const &v = a_n.GetValue(0);
+  for (g_evid = 1; g_evid <= 10; ++g_evid) {
+    TestNodeProcess(a_n, g_evid);
+    TEST_CMP(v.GetV().size(), ==, 1U);
+
+    auto coarse = PERIOD * (g_evid + 1);
+    TEST_CMP(std::abs(v.GetV(0, false) - coarse), <, 1e-6);
+  }
+
+  for (; g_evid <= 20; ++g_evid) {
+    TestNodeProcess(a_n, g_evid);
+    TEST_CMP(v.GetV().size(), ==, 1U);
+
+    auto coarse = PERIOD * (g_evid + 1);
+    auto fine = EvidToFineRaw();
+
+    auto time = v.GetV(0, false);
+    if (0 == fine) {
+      TEST_CMP(time, >, coarse - 2*PERIOD/3 - 1e-3);
+      TEST_CMP(time, <, coarse + 1e-3);
+    } else {
+      TEST_CMP(time, >, coarse - PERIOD - 1e-3);
+      TEST_CMP(time, <, coarse - 2*PERIOD/3 + 1e-3);
+    }
+  }
+}
+
 void MyTest::Run()
 {
   {
@@ -62,7 +95,6 @@ void MyTest::Run()
     MockNodeValue nvc(Input::kUint64, 1, ProcessExtraCoarse);
     MockNodeValue nvf(Input::kUint64, 1, ProcessExtraFine);
 
-#define PERIOD 10.0
     NodeCoarseFine n("", &nvc, &nvf, PERIOD);
 
     auto const &v = n.GetValue(0);
@@ -71,30 +103,21 @@ void MyTest::Run()
     nvc.Preprocess(&n);
     nvf.Preprocess(&n);
 
-    for (g_evid = 1; g_evid <= 10; ++g_evid) {
-      TestNodeProcess(n, g_evid);
-      TEST_CMP(v.GetV().size(), ==, 1U);
+    Check20(n);
+  }
+  {
+    // A replica converts with the calibration synced from the primary.
+    MockNodeValue nvc(Input::kUint64, 1, ProcessExtraCoarse);
+    MockNodeValue nvf(Input::kUint64, 1, ProcessExtraFine);
 
-      auto coarse = PERIOD * (g_evid + 1);
-      TEST_CMP(std::abs(v.GetV(0, false) - coarse), <, 1e-6);
-    }
+    NodeCoarseFine primary("", &nvc, &nvf, PERIOD);
+    NodeCoarseFine n("", &nvc, &nvf, PERIOD);
+    n.SetPrimary(&primary);
 
-    for (; g_evid <= 20; ++g_evid) {
-      TestNodeProcess(n, g_evid);
-      TEST_CMP(v.GetV().size(), ==, 1U);
-
-      auto coarse = PERIOD * (g_evid + 1);
-      auto fine = EvidToFineRaw();
-
-      auto time = v.GetV(0, false);
-      if (0 == fine) {
-        TEST_CMP(time, >, coarse - 2*PERIOD/3 - 1e-3);
-        TEST_CMP(time, <, coarse + 1e-3);
-      } else {
-        TEST_CMP(time, >, coarse - PERIOD - 1e-3);
-        TEST_CMP(time, <, coarse - 2*PERIOD/3 + 1e-3);
-      }
-    }
+    nvc.Preprocess(&n);
+    nvf.Preprocess(&n);
+
+    Check20(n);
   }
 }
 
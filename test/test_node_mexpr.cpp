@@ -0,0 +1,166 @@
+/*
+ * plutt, a scriptable monitor for experimental data.
+ *
+ * Copyright (C) 2023  Hans Toshihide Toernqvist <hans.tornqvist@chalmers.se>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301  USA
+ */
+
+#include <cmath>
+#include <test/test.hpp>
+#include <node_mexpr.hpp>
+#include <test/mock_node.hpp>
+
+namespace {
+
+class MyTest: public Test {
+  void Run();
+};
+MyTest g_test_node_mexpr_;
+
+void ProcessExtraU64(MockNodeValue &a_nv)
+{
+  Input::Scalar s;
+
+  s.u64 = 3;
+  a_nv.m_value[0].Push(1, s);
+  // Integers are signed in expressions.
+  s.u64 = (uint64_t)-2;
+  a_nv.m_value[0].Push(2, s);
+}
+
+void ProcessExtraDbl(MockNodeValue &a_nv)
+{
+  Input::Scalar s;
+
+  s.dbl = 0.5;
+  a_nv.m_value[0].Push(1, s);
+  s.dbl = 1.5;
+  a_nv.m_value[0].Push(2, s);
+}
+
+void ProcessExtraDbl2(MockNodeValue &a_nv)
+{
+  Input::Scalar s;
+
+  s.dbl = 0.5;
+  a_nv.m_value[0].Push(1, s);
+  s.dbl = 2.5;
+  a_nv.m_value[0].Push(1, s);
+  s.dbl = 1.5;
+  a_nv.m_value[0].Push(2, s);
+}
+
+void MyTest::Run()
+{
+  {
+    MockNodeValue nv_l(Input::kUint64, 1, ProcessExtraU64);
+    NodeMExpr n("a", &nv_l, nullptr, 1.0, NodeMExpr::ADD);
+    TestNodeBase(n, "a");
+  }
+  {
+    // Mixed types.
+    MockNodeValue nv_l(Input::kUint64, 1, ProcessExtraU64);
+    MockNodeValue nv_r(Input::kDouble, 1, ProcessExtraDbl);
+    NodeMExpr n("", &nv_l, &nv_r, 0.0, NodeMExpr::ADD);
+
+    TEST_CMP(n.GetDepVec().size(), ==, 2U);
+    TEST_CMP(n.GetDepVec()[0], ==, &nv_l);
+    TEST_CMP(n.GetDepVec()[1], ==, &nv_r);
+
+    nv_l.Preprocess(&n);
+    nv_r.Preprocess(&n);
+    TestNodeProcess(n, 1);
+
+    auto const &x = n.GetValue(0);
+    TEST_CMP(x.GetType(), ==, Input::kDouble);
+    TEST_CMP(x.GetMI().size(), ==, 2U);
+    TEST_CMP(x.GetMI()[0], ==, 1U);
+    TEST_CMP(x.GetMI()[1], ==, 2U);
+    TEST_CMP(x.GetV().size(), ==, 2U);
+    TEST_CMP(x.GetV()[0].dbl, ==, 3.5);
+    TEST_CMP(x.GetV()[1].dbl, ==, -0.5);
+  }
+  {
+    // Constant on the left.
+    MockNodeValue nv_r(Input::kUint64, 1, ProcessExtraU64);
+    NodeMExpr n("", nullptr, &nv_r, 10.0, NodeMExpr::SUB);
+
+    TEST_CMP(n.GetDepVec().size(), ==, 1U);
+
+    nv_r.Preprocess(&n);
+    TestNodeProcess(n, 1);
+
+    auto const &x = n.GetValue(0);
+    TEST_CMP(x.GetV().size(), ==, 2U);
+    TEST_CMP(x.GetV()[0].dbl, ==, 7.0);
+    TEST_CMP(x.GetV()[1].dbl, ==, 12.0);
+  }
+  {
+    // Constant on the right, non-finite results are dropped.
+    MockNodeValue nv_l(Input::kDouble, 1, ProcessExtraDbl);
+    NodeMExpr n("", &nv_l, nullptr, 0.0, NodeMExpr::DIV);
+
+    nv_l.Preprocess(&n);
+    TestNodeProcess(n, 1);
+
+    auto const &x = n.GetValue(0);
+    TEST_BOOL(x.GetMI().empty());
+    TEST_BOOL(x.GetV().empty());
+  }
+  {
+    // Nested expressions are fused, i.e. sqrt(1/(x*x)-1).
+    MockNodeValue nv(Input::kDouble, 1, ProcessExtraDbl);
+    NodeMExpr sq("", &nv, &nv, 0.0, NodeMExpr::MUL);
+    NodeMExpr inv("", nullptr, &sq, 1.0, NodeMExpr::DIV);
+    NodeMExpr sub("", &inv, nullptr, 1.0, NodeMExpr::SUB);
+    NodeMExpr n("", &sub, nullptr, 0.0, NodeMExpr::SQRT);
+
+    TEST_CMP(n.GetDepVec().size(), ==, 1U);
+    TEST_CMP(n.GetDepVec()[0], ==, &nv);
+
+    nv.Preprocess(&n);
+    TestNodeProcess(n, 1);
+
+    // Only the fused node ran, the 2nd element is sqrt(<0) and dropped.
+    TEST_BOOL(sq.GetValue(0).GetMI().empty());
+    auto const &x = n.GetValue(0);
+    TEST_CMP(x.GetMI().size(), ==, 1U);
+    TEST_CMP(x.GetMI()[0], ==, 1U);
+    TEST_CMP(x.GetV().size(), ==, 1U);
+    TEST_CMP(x.GetV()[0].dbl, ==, sqrt(3.0));
+  }
+  {
+    // Uneven channels pair up to the shortest, (l + r) * 2.
+    MockNodeValue nv_l(Input::kDouble, 1, ProcessExtraDbl2);
+    MockNodeValue nv_r(Input::kUint64, 1, ProcessExtraU64);
+    NodeMExpr sum("", &nv_l, &nv_r, 0.0, NodeMExpr::ADD);
+    NodeMExpr n("", &sum, nullptr, 2.0, NodeMExpr::MUL);
+
+    nv_l.Preprocess(&n);
+    nv_r.Preprocess(&n);
+    TestNodeProcess(n, 1);
+
+    auto const &x = n.GetValue(0);
+    TEST_CMP(x.GetMI().size(), ==, 2U);
+    TEST_CMP(x.GetME()[0], ==, 1U);
+    TEST_CMP(x.GetME()[1], ==, 2U);
+    TEST_CMP(x.GetV()[0].dbl, ==, 7.0);
+    TEST_CMP(x.GetV()[1].dbl, ==, -1.0);
+  }
+}
+
+}
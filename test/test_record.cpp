@@ -0,0 +1,136 @@
+/*
+ * plutt, a scriptable monitor for experimental data.
+ *
+ * Copyright (C) 2023  Hans Toshihide Toernqvist <hans.tornqvist@chalmers.se>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301  USA
+ */
+
+#include <test/test.hpp>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdio>
+#include <config.hpp>
+#include <record.hpp>
+#include <test/mock_input.hpp>
+
+namespace {
+
+class MyTest: public Test {
+  void Run();
+};
+MyTest g_test_record_;
+
+void MyTest::Run()
+{
+#define FILENAME "plutt_test_.rec"
+  // Record two events of two members each, the second of "b" is empty.
+  {
+    Config config("test/test_record.plutt", nullptr);
+    config.BindSignal("a", "", 0, Input::kUint64);
+    config.BindSignal("b", "v", 1, Input::kDouble);
+    MockInput input;
+    input.m_vec.resize(2);
+    Recorder recorder(config, FILENAME);
+
+    Input::Scalar s;
+    s.u64 = 5;
+    input.m_vec[0].push_back(s);
+    s.dbl = 1.5;
+    input.m_vec[1].push_back(s);
+    s.dbl = 2.5;
+    input.m_vec[1].push_back(s);
+    recorder.Write(&input, 0);
+
+    input.m_vec[0][0].u64 = 7;
+    input.m_vec[1].clear();
+    recorder.Write(&input, 0);
+  }
+
+  // Replay into two slots.
+  {
+    Config config("test/test_record.plutt", nullptr);
+    Replay replay(config, 2, FILENAME);
+    auto const &binding_vec = config.GetBindingVec();
+    TEST_CMP(binding_vec.size(), ==, 2U);
+
+    TEST_BOOL(replay.Fetch());
+    replay.Buffer(1);
+    TEST_BOOL(replay.Fetch());
+    replay.Buffer(0);
+    TEST_BOOL(!replay.Fetch());
+
+    auto a = replay.GetData(1, 0);
+    TEST_CMP(a.second, ==, 1U);
+    TEST_CMP(a.first[0].u64, ==, 5U);
+    auto b = replay.GetData(1, 1);
+    TEST_CMP(b.second, ==, 2U);
+    TEST_CMP(b.first[0].dbl, ==, 1.5);
+    TEST_CMP(b.first[1].dbl, ==, 2.5);
+
+    a = replay.GetData(0, 0);
+    TEST_CMP(a.second, ==, 1U);
+    TEST_CMP(a.first[0].u64, ==, 7U);
+    b = replay.GetData(0, 1);
+    TEST_CMP(b.second, ==, 0U);
+  }
+
+  // A cut-off last event ends the replay.
+  {
+    struct stat st;
+    TEST_CMP(stat(FILENAME, &st), ==, 0);
+    TEST_CMP(truncate(FILENAME, st.st_size - 4), ==, 0);
+
+    Config config("test/test_record.plutt", nullptr);
+    Replay replay(config, 1, FILENAME);
+    TEST_BOOL(replay.Fetch());
+    replay.Buffer(0);
+    TEST_CMP(replay.GetData(0, 0).first[0].u64, ==, 5U);
+    TEST_BOOL(!replay.Fetch());
+    TEST_BOOL(!replay.Fetch());
+  }
+
+  // A name length that would wrap the header offset, and an unknown type.
+  {
+    auto file = fopen(FILENAME, "r+b");
+    TEST_BOOL(nullptr != file);
+    uint64_t u64 = ~(uint64_t)0;
+    fseek(file, 24, SEEK_SET);
+    fwrite(&u64, sizeof u64, 1, file);
+    fflush(file);
+
+    Config config("test/test_record.plutt", nullptr);
+    TEST_TRY;
+    Replay replay(config, 1, FILENAME);
+    TEST_CATCH;
+
+    u64 = 1;
+    fseek(file, 24, SEEK_SET);
+    fwrite(&u64, sizeof u64, 1, file);
+    u64 = 9;
+    fseek(file, 16, SEEK_SET);
+    fwrite(&u64, sizeof u64, 1, file);
+    fclose(file);
+
+    TEST_TRY;
+    Replay replay(config, 1, FILENAME);
+    TEST_CATCH;
+  }
+
+  remove(FILENAME);
+}
+
+}
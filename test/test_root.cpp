@@ -73,30 +73,30 @@ void MyTest::Run()
   delete file;
   delete cls;
 
-  auto config = new Config("test/test_root.plutt");
+  auto config = new Config("test/test_root.plutt", nullptr);
   char *argv[2];
   argv[0] = strdup("tree");
   argv[1] = strdup(FILENAME);
-  auto root = new Root(*config, 2, argv);
+  auto root = new Root(*config, 1, 2, argv);
   free(argv[0]);
   free(argv[1]);
 
   for (unsigned char i = 0; i < 10; ++i) {
     root->Fetch();
-    root->Buffer();
+    root->Buffer(0);
 
-    auto data_cls_d = root->GetData(0);
-    auto data_cls_f = root->GetData(1);
-    auto data_cls_uc = root->GetData(2);
-    auto data_cls_ui = root->GetData(3);
-    auto data_cls_ul = root->GetData(4);
-    auto data_cls_us = root->GetData(5);
-    auto data_d = root->GetData(6);
-    auto data_f = root->GetData(7);
-    auto data_uc = root->GetData(8);
-    auto data_ui = root->GetData(9);
-    auto data_ul = root->GetData(10);
-    auto data_us = root->GetData(11);
+    auto data_cls_d = root->GetData(0, 0);
+    auto data_cls_f = root->GetData(0, 1);
+    auto data_cls_uc = root->GetData(0, 2);
+    auto data_cls_ui = root->GetData(0, 3);
+    auto data_cls_ul = root->GetData(0, 4);
+    auto data_cls_us = root->GetData(0, 5);
+    auto data_d = root->GetData(0, 6);
+    auto data_f = root->GetData(0, 7);
+    auto data_uc = root->GetData(0, 8);
+    auto data_ui = root->GetData(0, 9);
+    auto data_ul = root->GetData(0, 10);
+    auto data_us = root->GetData(0, 11);
 
     TEST_CMP(std::abs(data_cls_d.first->dbl - i), <, 1e-9);
     TEST_CMP(std::abs(data_cls_f.first->dbl - i), <, 1e-9);
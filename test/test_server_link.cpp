@@ -0,0 +1,123 @@
+/*
+ * plutt, a scriptable monitor for experimental data.
+ *
+ * Copyright (C) 2023  Hans Toshihide Toernqvist <hans.tornqvist@chalmers.se>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301  USA
+ */
+
+#include <test/test.hpp>
+#include <algorithm>
+#include <deque>
+#include <server_link.hpp>
+
+namespace {
+
+class MyTest: public Test {
+  void Run();
+};
+MyTest g_test_server_link_;
+
+// Plays back scripted connects and fetches, a fetch writes its value all
+// over the buffer so left-overs of a lost event show.
+class FakeClient: public ServerLink::Client {
+  public:
+    FakeClient():
+      m_connect_deq(),
+      m_fetch_deq(),
+      m_connect_n(),
+      m_pause_n()
+    {
+    }
+    bool Connect()
+    {
+      ++m_connect_n;
+      if (m_connect_deq.empty()) {
+        return false;
+      }
+      auto ok = m_connect_deq.front();
+      m_connect_deq.pop_front();
+      return ok;
+    }
+    int Fetch(std::vector<uint8_t> *a_buf)
+    {
+      if (m_fetch_deq.empty()) {
+        return 0;
+      }
+      auto v = m_fetch_deq.front();
+      m_fetch_deq.pop_front();
+      if (v < 0) {
+        // Lost half-way through an event.
+        std::fill(a_buf->begin(), a_buf->begin() + a_buf->size() / 2,
+            0xee);
+        return v;
+      }
+      a_buf->assign(a_buf->size(), (uint8_t)v);
+      return 1;
+    }
+    bool Pause()
+    {
+      ++m_pause_n;
+      return true;
+    }
+    std::deque<bool> m_connect_deq;
+    // >= 0 for an event with that value, -1 for a lost server.
+    std::deque<int> m_fetch_deq;
+    unsigned m_connect_n;
+    unsigned m_pause_n;
+};
+
+void MyTest::Run()
+{
+  // Lost mid-event, two failed tries, then the server is back.
+  {
+    FakeClient client;
+    ServerLink link("fake", &client, 60);
+    client.m_connect_deq.push_back(true);
+    TEST_BOOL(link.Connect());
+
+    std::vector<uint8_t> buf(4);
+    client.m_fetch_deq.push_back(1);
+    client.m_fetch_deq.push_back(-1);
+    client.m_fetch_deq.push_back(3);
+    client.m_connect_deq.push_back(false);
+    client.m_connect_deq.push_back(false);
+    client.m_connect_deq.push_back(true);
+    TEST_BOOL(link.Fetch(&buf));
+    TEST_CMP(buf[0], ==, 1);
+    TEST_BOOL(link.Fetch(&buf));
+    TEST_CMP(buf.size(), ==, 4U);
+    TEST_CMP(buf[0], ==, 3);
+    TEST_CMP(buf[3], ==, 3);
+    TEST_CMP(client.m_connect_n, ==, 4U);
+    TEST_CMP(client.m_pause_n, ==, 2U);
+  }
+
+  // The end of data is a lost server too, which never comes back.
+  {
+    FakeClient client;
+    ServerLink link("fake", &client, 60);
+    client.m_connect_deq.push_back(true);
+    TEST_BOOL(link.Connect());
+
+    std::vector<uint8_t> buf(4);
+    TEST_BOOL(!link.Fetch(&buf));
+    TEST_CMP(client.m_connect_n, ==, 61U);
+    TEST_CMP(client.m_pause_n, ==, 59U);
+  }
+}
+
+}
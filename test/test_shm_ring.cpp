@@ -0,0 +1,128 @@
+/*
+ * plutt, a scriptable monitor for experimental data.
+ *
+ * Copyright (C) 2023  Hans Toshihide Toernqvist <hans.tornqvist@chalmers.se>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301  USA
+ */
+
+#include <test/test.hpp>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <config.hpp>
+#include <shm_ring.hpp>
+
+#define SHM_NAME "/plutt_test_"
+
+namespace {
+
+class MyTest: public Test {
+  void Run();
+};
+MyTest g_test_shm_ring_;
+
+// Event i has "a" = i, and i % 3 values of "b" = i.
+void Produce(ShmRingWriter *a_writer, unsigned a_i)
+{
+  a_writer->Begin();
+  a_writer->Data(0)[0].u64 = a_i;
+  a_writer->SetLen(0, 1);
+  auto b = a_writer->Data(1);
+  for (unsigned j = 0; j < a_i % 3; ++j) {
+    b[j].dbl = a_i;
+  }
+  a_writer->SetLen(1, a_i % 3);
+  a_writer->Commit();
+}
+
+void Check(ShmRing *a_ring, unsigned a_slot, unsigned a_i)
+{
+  auto a = a_ring->GetData(a_slot, 0);
+  TEST_CMP(a.second, ==, 1U);
+  TEST_CMP(a.first[0].u64, ==, a_i);
+  auto b = a_ring->GetData(a_slot, 1);
+  TEST_CMP(b.second, ==, a_i % 3);
+  for (unsigned j = 0; j < b.second; ++j) {
+    TEST_CMP(b.first[j].dbl, ==, a_i);
+  }
+}
+
+void MyTest::Run()
+{
+  std::vector<ShmRingMember> member_vec(2);
+  memset(member_vec.data(), 0, member_vec.size() * sizeof member_vec[0]);
+  strcpy(member_vec[0].name, "a");
+  member_vec[0].type = Input::kUint64;
+  member_vec[0].max_len = 1;
+  strcpy(member_vec[1].name, "b");
+  strcpy(member_vec[1].suffix, "v");
+  member_vec[1].type = Input::kDouble;
+  member_vec[1].max_len = 2;
+  ShmRingWriter writer(SHM_NAME, member_vec, 4);
+
+  Config config("test/test_shm_ring.plutt", nullptr);
+  ShmRing ring(config, 2, SHM_NAME);
+
+  // In step.
+  Produce(&writer, 0);
+  Produce(&writer, 1);
+  TEST_BOOL(ring.Fetch());
+  ring.Buffer(0);
+  TEST_BOOL(ring.Fetch());
+  ring.Buffer(1);
+  Check(&ring, 0, 0);
+  Check(&ring, 1, 1);
+
+  // Lapped in the ring, the oldest events still there are taken.
+  for (unsigned i = 2; i < 12; ++i) {
+    Produce(&writer, i);
+  }
+  TEST_BOOL(ring.Fetch());
+  ring.Buffer(0);
+  Check(&ring, 0, 8);
+
+  // Lapped after buffering, the slot keeps its copy.
+  for (unsigned i = 12; i < 16; ++i) {
+    Produce(&writer, i);
+  }
+  Check(&ring, 0, 8);
+
+  writer.Done();
+  for (unsigned i = 12; i < 16; ++i) {
+    TEST_BOOL(ring.Fetch());
+    ring.Buffer(1);
+    Check(&ring, 1, i);
+  }
+  TEST_BOOL(!ring.Fetch());
+
+  // A producer which neither commits nor is done, Stop ends the wait.
+  {
+    ShmRingWriter stalled(SHM_NAME "stalled", member_vec, 4);
+    Config stalled_config("test/test_shm_ring.plutt", nullptr);
+    ShmRing stalled_ring(stalled_config, 1, SHM_NAME "stalled");
+    bool ok = true;
+    std::thread thread([&stalled_ring, &ok]{
+        ok = stalled_ring.Fetch();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    stalled_ring.Stop();
+    thread.join();
+    TEST_BOOL(!ok);
+  }
+}
+
+}
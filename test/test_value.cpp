@@ -83,11 +83,25 @@ void MyTest::Run()
     TEST_CMP(v.GetV().at(1).u64, ==, 100U);
     TEST_CMP(v.GetV().at(2).u64, ==, 1000U);
 
+    {
+      auto mi = v.GetMISpan();
+      auto me = v.GetMESpan();
+      auto vv = v.GetVSpan();
+      TEST_CMP(mi.size(), ==, 2U);
+      TEST_CMP(mi[1], ==, 2U);
+      TEST_CMP(me[1], ==, 3U);
+      TEST_CMP(vv.size(), ==, 3U);
+      TEST_CMP(vv[0].u64, ==, 10U);
+      TEST_CMP(vv[2].u64, ==, 1000U);
+      TEST_CMP((ValueToDouble<uint64_t, false>::Get(vv[1])), ==, 100.0);
+    }
+
     v.Clear();
     TEST_CMP(v.GetType(), ==, Input::kUint64);
     TEST_BOOL(v.GetMI().empty());
     TEST_BOOL(v.GetME().empty());
     TEST_BOOL(v.GetV().empty());
+    TEST_BOOL(v.GetVSpan().empty());
   }
 }
 
@@ -157,6 +157,62 @@ void MyTest::Run()
     TEST_BOOL(!v.empty());
     TEST_CMP(v.size(), ==, 1U);
   }
+
+  {
+    // Test reservation and growth.
+    Vector<int> v;
+
+    v.reserve(10);
+
+    TEST_BOOL(v.empty());
+    TEST_CMP(v.capacity(), ==, 10U);
+
+    for (int i = 0; i < 10; ++i) {
+      v.push_back(i);
+    }
+    TEST_CMP(v.capacity(), ==, 10U);
+    TEST_CMP(v.at(9), ==, 9);
+
+    v.push_back(10);
+    TEST_CMP(v.capacity(), ==, 20U);
+    for (int i = 0; i < 11; ++i) {
+      TEST_CMP(v.at((size_t)i), ==, i);
+    }
+
+    v.reserve(5);
+    TEST_CMP(v.capacity(), ==, 20U);
+    TEST_CMP(v.size(), ==, 11U);
+
+    v.clear();
+    TEST_CMP(v.capacity(), ==, 20U);
+  }
+
+  {
+    // Test spans.
+    Vector<int> v;
+
+    auto s0 = v.span();
+    TEST_BOOL(s0.empty());
+    TEST_CMP(s0.begin(), ==, s0.end());
+
+    v.push_back(1);
+    v.push_back(2);
+    auto s = v.span();
+    TEST_CMP(s.size(), ==, 2U);
+    TEST_CMP(s[0], ==, 1);
+    TEST_CMP(s[1], ==, 2);
+    TEST_CMP(s.back(), ==, 2);
+    TEST_CMP(s.begin(), ==, v.begin());
+    TEST_CMP(s.end(), ==, v.end());
+#ifndef PLUTT_UNCHECKED
+    TEST_TRY;
+    s[2];
+    TEST_CATCH;
+    TEST_TRY;
+    s0.back();
+    TEST_CATCH;
+#endif
+  }
 }
 
 }
@@ -0,0 +1,37 @@
+#!/bin/bash
+
+# plutt, a scriptable monitor for experimental data.
+#
+# Copyright (C) 2023  Hans Toshihide Toernqvist <hans.tornqvist@chalmers.se>
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 2.1 of the License, or (at your option) any later version.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with this library; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+# MA  02110-1301  USA
+
+# ucesb struct server for trying out "plutt -s", restarts the server every
+# time it exits so the client has to reconnect, eg:
+#  test/ucesb_server.sh path/to/unpacker file.lmd
+#  ./plutt -f cfg.plutt -s localhost path/to/unpacker
+
+if [ $# -lt 2 ]; then
+  echo "Usage: $0 unpacker input..." >&2
+  exit 1
+fi
+unpacker=$1
+shift
+for ((i = 1;; ++i)); do
+  echo "Server run $i."
+  $unpacker $* --ntuple=RAW,STRUCT,server || exit 1
+  sleep 2
+done
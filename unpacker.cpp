@@ -27,28 +27,74 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <wordexp.h>
+#include <algorithm>
+#include <chrono>
+#include <csignal>
 #include <cstring>
 #include <fstream>
+#include <functional>
 #include <sstream>
 #include <stdexcept>
 #include <vector>
 #include <config.hpp>
+#include <util.hpp>
 
 #include <iostream>
 
-#define MATCH_WORD(p, str) (0 == strncmp(p, str, sizeof str - 1) && \
-    !isalnum(p[sizeof str - 1]) && '_' != p[sizeof str - 1])
+#define STRUCT_CACHE_MAGIC "plutt-struct-1"
 
-Unpacker::Unpacker(Config &a_config, int a_argc, char **a_argv):
+Unpacker::Unpacker(Config &a_config, unsigned a_slot_num, int a_argc, char
+    **a_argv, char const *a_server, unsigned a_part_n, char const *a_ts):
   m_path(a_argv[0]),
-  m_clnt(),
-  m_pip(),
+  m_server(a_server ? a_server : ""),
+  m_clnt_vec(),
+  m_pip_vec(),
+  m_pid_vec(),
+  m_server_client(this),
+  m_server_link(m_server, &m_server_client, kReconnectTries),
+  m_part_state(a_part_n, kPartIdle),
+  m_part_buf(a_part_n),
+  m_part_thread_vec(),
+  m_part_mutex(),
+  m_part_cv(),
+  m_part_free(),
+  m_part_ready(),
+  m_part_done_n(),
+  m_part_error(),
+  m_part_stop(),
+  m_is_merged(),
+  m_ts_lo_i(kNoCtrl),
+  m_ts_hi_i(kNoCtrl),
   m_struct_info(),
   m_map(),
   m_event_buf(),
   m_out_size(),
-  m_out_buf()
+  m_raw_buf(a_slot_num),
+  m_out_buf(a_slot_num),
+  m_out_len(a_slot_num),
+  m_slot_gen(a_slot_num),
+  m_conv_gen(a_slot_num)
 {
+  if (!m_server.empty() && a_part_n > 1) {
+    std::cerr << m_server << ": Cannot split a server stream.\n";
+    throw std::runtime_error(__func__);
+  }
+
+  // Timestamp signals for the ordered merge, unpacked even if not plotted.
+  std::vector<std::string> ts_vec;
+  if (a_ts) {
+    std::istringstream iss(a_ts);
+    std::string name;
+    while (std::getline(iss, name, ',')) {
+      ts_vec.push_back(name);
+    }
+    if (ts_vec.empty() || ts_vec.size() > 2) {
+      std::cerr << a_ts << ": Need lo[,hi] timestamp signals.\n";
+      throw std::runtime_error(__func__);
+    }
+    m_is_merged = true;
+  }
+
   // Make string of signals.
   std::string signals_str;
   auto signal_list = a_config.GetSignalList();
@@ -56,227 +102,239 @@ Unpacker::Unpacker(Config &a_config, int a_argc, char **a_argv):
     signals_str += *it;
     signals_str += ',';
   }
-
-  // Generate struct file.
-  auto temp_path_c = strdup("pluttXXXXXX.h");
-  auto fd = mkstemps(temp_path_c, 2);
-  if (-1 == fd) {
-    perror("mkstemps");
-    free(temp_path_c);
-    throw std::runtime_error(__func__);
-  }
-  close(fd);
-  std::string temp_path(temp_path_c);
-  free(temp_path_c);
-  auto pid = fork();
-  if (-1 == pid) {
-    perror("fork");
-    remove(temp_path.c_str());
-    throw std::runtime_error(__func__);
-  }
-  if (0 == pid) {
-    std::ostringstream oss;
-    oss << "--ntuple=STRUCT_HH," << signals_str << "id=plutt," << temp_path;
-    wordexp_t exp = {0};
-    if (0 != wordexp(m_path.c_str(), &exp, 0)) {
-      perror("wordexp");
-      _exit(EXIT_FAILURE);
-    }
-    if (1 != exp.we_wordc) {
-      std::cerr << m_path << ": Does not resolve to single unpacker.\n";
-      _exit(EXIT_FAILURE);
-    }
-    std::string path = exp.we_wordv[0];
-    std::cout << "Struct call: " << path << ' ' << path << ' ' << oss.str() <<
-        '\n';
-    execl(path.c_str(), path.c_str(), oss.str().c_str(), nullptr);
-    perror("exec");
-    _exit(EXIT_FAILURE);
-  } else {
-    int status = 0;
-    if (-1 == wait(&status)) {
-      perror("wait");
-      remove(temp_path.c_str());
-      throw std::runtime_error(__func__);
-    }
-    if (!WIFEXITED(status) || 0 != WEXITSTATUS(status)) {
-      std::cerr << m_path << ": failed to get struct.\n";
-      remove(temp_path.c_str());
-      throw std::runtime_error(__func__);
+  for (auto it = ts_vec.begin(); ts_vec.end() != it; ++it) {
+    if (signal_list.end() == std::find(signal_list.begin(),
+        signal_list.end(), *it)) {
+      signals_str += *it;
+      signals_str += ',';
     }
   }
 
-  // Prepare parsing of struct.
-  struct stat st;
-  if (-1 == stat(temp_path.c_str(), &st)) {
-    perror("stat");
-    throw std::runtime_error(__func__);
-  }
-  std::vector<char> buf_file(static_cast<size_t>(st.st_size) + 1);
-  std::ifstream ifile(temp_path.c_str());
-  ifile.read(&buf_file.at(0), st.st_size);
-  ifile.close();
-  remove(temp_path.c_str());
-
-  auto buf_macro = ExtractRange(buf_file, "_ITEMS_INFO", " while (0)");
+  auto item_map = LoadItems(signals_str);
 
   // Find signals in struct and allocate scalars/vectors.
   std::map<std::string, uint32_t> signal_map;
   size_t event_buf_i = 0;
   for (auto it = signal_list.begin(); signal_list.end() != it; ++it) {
-    BindSignal(a_config, buf_macro, *it, nullptr, nullptr, event_buf_i,
-        signal_map, false);
-    BindSignal(a_config, buf_macro, *it,  "M",  "M", event_buf_i, signal_map,
-        true);
-    BindSignal(a_config, buf_macro, *it,  "I",  "I", event_buf_i, signal_map,
-        true);
-    BindSignal(a_config, buf_macro, *it, "MI", "MI", event_buf_i, signal_map,
-        true);
-    BindSignal(a_config, buf_macro, *it, "ME", "ME", event_buf_i, signal_map,
-        true);
-    BindSignal(a_config, buf_macro, *it,  "v",  "v", event_buf_i, signal_map,
-        true);
-    BindSignal(a_config, buf_macro, *it,  "E",  "v", event_buf_i, signal_map,
-        true);
+    BindSignal(a_config, item_map, *it, nullptr, nullptr, event_buf_i,
+        signal_map, false, true);
+    BindSignal(a_config, item_map, *it,  "M",  "M", event_buf_i, signal_map,
+        true, true);
+    BindSignal(a_config, item_map, *it,  "I",  "I", event_buf_i, signal_map,
+        true, true);
+    BindSignal(a_config, item_map, *it, "MI", "MI", event_buf_i, signal_map,
+        true, true);
+    BindSignal(a_config, item_map, *it, "ME", "ME", event_buf_i, signal_map,
+        true, true);
+    BindSignal(a_config, item_map, *it,  "v",  "v", event_buf_i, signal_map,
+        true, true);
+    BindSignal(a_config, item_map, *it,  "E",  "v", event_buf_i, signal_map,
+        true, true);
+  }
+  for (size_t i = 0; i < ts_vec.size(); ++i) {
+    BindSignal(a_config, item_map, ts_vec[i], nullptr, nullptr,
+        event_buf_i, signal_map, false, false);
+    auto &ts_i = 0 == i ? m_ts_lo_i : m_ts_hi_i;
+    for (size_t j = 0; j < m_map.size(); ++j) {
+      if (ts_vec[i] == m_map[j].name) {
+        ts_i = j;
+      }
+    }
+    if (kNoCtrl == ts_i || 1 != m_map[ts_i].len) {
+      std::cerr << ts_vec[i] << ": Timestamp not a scalar.\n";
+      throw std::runtime_error(__func__);
+    }
   }
   m_event_buf.resize(event_buf_i);
-  m_out_buf.resize(m_out_size);
-
-  /* Run unpacker and connect. */
-  std::string cmd = std::string(m_path) + " --ntuple=RAW," + signals_str +
-      "STRUCT,-";
-  for (int arg_i = 1; arg_i < a_argc; ++arg_i) {
-    cmd += " ";
-    cmd += a_argv[arg_i];
-  }
-  std::cout << "popen(" << cmd << ")\n";
-  m_pip = popen(cmd.c_str(), "r");
-  if (!m_pip) {
-    perror("popen");
-    throw std::runtime_error(__func__);
+  for (auto it = m_part_buf.begin(); m_part_buf.end() != it; ++it) {
+    it->resize(event_buf_i);
   }
-  m_clnt = new ext_data_clnt;
-  fd = fileno(m_pip);
-  if (-1 == fd) {
-    perror("fileno");
-    throw std::runtime_error(__func__);
+  for (unsigned i = 0; i < a_slot_num; ++i) {
+    m_raw_buf[i].resize(event_buf_i);
+    m_out_buf[i].resize(m_out_size);
+    m_out_len[i].resize(m_map.size());
+    m_conv_gen[i].resize(m_map.size());
   }
-  if (!m_clnt->connect(fd)) {
-    perror("ext_data_clnt::ext_data_from_fd");
-    throw std::runtime_error(__func__);
+
+  if (!m_server.empty()) {
+    // The unpacker runs elsewhere, the local one only gave the struct.
+    m_clnt_vec.push_back(nullptr);
+    m_pip_vec.push_back(nullptr);
+    if (!m_server_link.Connect()) {
+      throw std::runtime_error(__func__);
+    }
+    return;
   }
-  uint32_t success = 0;
-  if (-1 == m_clnt->setup(nullptr, 0, &m_struct_info, &success, event_buf_i))
-  {
-    perror("ext_data_clnt::setup");
-    std::cerr << m_clnt->last_error() << '\n';
-    throw std::runtime_error(__func__);
+
+  /*
+   * Run unpackers and connect, files are dealt out over the parts. Only
+   * arguments naming files are dealt, so option values given as separate
+   * arguments go to every part, but inputs given as options would be read
+   * by every part.
+   */
+  std::vector<bool> is_file_vec((size_t)a_argc);
+  unsigned file_n = 0;
+  if (a_part_n > 1) {
+    char const *c_input_opt[] = {
+      "--file=", "--stream=", "--trans=", "--evapi=", "--rfio="
+    };
+    for (int arg_i = 1; arg_i < a_argc; ++arg_i) {
+      auto arg = a_argv[arg_i];
+      for (size_t i = 0; i < LENGTH(c_input_opt); ++i) {
+        auto opt = c_input_opt[i];
+        if (0 == strncmp(arg, opt, strlen(opt))) {
+          std::cerr << arg << ": Input options cannot be split over "
+              "parts, give files.\n";
+          throw std::runtime_error(__func__);
+        }
+      }
+      struct stat st;
+      if ('-' != arg[0] && 0 == stat(arg, &st) && S_ISREG(st.st_mode)) {
+        is_file_vec[(size_t)arg_i] = true;
+        ++file_n;
+      }
+    }
+    if (file_n < a_part_n) {
+      std::cerr << m_path << ": " << file_n << " files for " << a_part_n <<
+          " parts.\n";
+      throw std::runtime_error(__func__);
+    }
   }
-  uint32_t map_ok = EXT_DATA_ITEM_MAP_OK | EXT_DATA_ITEM_MAP_NO_DEST;
-  if (success & ~map_ok) {
-    perror("ext_data_clnt::setup");
-    ext_data_struct_info_print_map_success(m_struct_info, stderr, map_ok);
-    throw std::runtime_error(__func__);
+  for (unsigned part_i = 0; part_i < a_part_n; ++part_i) {
+    std::string cmd = std::string(m_path) + " --ntuple=RAW," + signals_str +
+        "STRUCT,-";
+    unsigned file_i = 0;
+    for (int arg_i = 1; arg_i < a_argc; ++arg_i) {
+      if (is_file_vec[(size_t)arg_i] && part_i != file_i++ % a_part_n) {
+        continue;
+      }
+      cmd += " ";
+      cmd += a_argv[arg_i];
+    }
+    // Like popen, but the shell execs the unpacker so Stop can signal it.
+    std::cout << "exec(" << cmd << ")\n";
+    auto sh_cmd = "exec " + cmd;
+    int fds[2];
+    if (-1 == pipe2(fds, O_CLOEXEC)) {
+      perror("pipe2");
+      throw std::runtime_error(__func__);
+    }
+    auto pid = fork();
+    if (-1 == pid) {
+      perror("fork");
+      close(fds[0]);
+      close(fds[1]);
+      throw std::runtime_error(__func__);
+    }
+    if (0 == pid) {
+      dup2(fds[1], STDOUT_FILENO);
+      execl("/bin/sh", "sh", "-c", sh_cmd.c_str(), nullptr);
+      perror("exec");
+      _exit(EXIT_FAILURE);
+    }
+    close(fds[1]);
+    m_pid_vec.push_back(pid);
+    auto pip = fdopen(fds[0], "r");
+    if (!pip) {
+      perror("fdopen");
+      close(fds[0]);
+      throw std::runtime_error(__func__);
+    }
+    m_pip_vec.push_back(pip);
+    m_clnt_vec.push_back(nullptr);
+    if (!Connect(part_i)) {
+      throw std::runtime_error(__func__);
+    }
+  }
+
+  if (!m_is_merged && a_part_n > 1) {
+    m_part_free.resize(kPartBufN * a_part_n);
+    for (auto it = m_part_free.begin(); m_part_free.end() != it; ++it) {
+      it->resize(event_buf_i);
+    }
+    for (unsigned part_i = 0; part_i < a_part_n; ++part_i) {
+      m_part_thread_vec.push_back(std::thread(&Unpacker::PartThread, this,
+          part_i));
+    }
   }
 }
 
 Unpacker::~Unpacker()
 {
-  delete m_clnt;
-  if (m_pip) {
-    if (-1 == pclose(m_pip)) {
-      perror("pclose");
+  // Readers return once their unpacker is gone.
+  Stop();
+  for (auto it = m_part_thread_vec.begin(); m_part_thread_vec.end() != it;
+      ++it) {
+    it->join();
+  }
+  for (auto it = m_clnt_vec.begin(); m_clnt_vec.end() != it; ++it) {
+    delete *it;
+  }
+  for (auto it = m_pip_vec.begin(); m_pip_vec.end() != it; ++it) {
+    if (*it) {
+      fclose(*it);
+    }
+  }
+  for (auto it = m_pid_vec.begin(); m_pid_vec.end() != it; ++it) {
+    if (-1 == waitpid(*it, nullptr, 0)) {
+      perror("waitpid");
     }
   }
 }
 
-void Unpacker::BindSignal(Config &a_config, std::vector<char> const
-    &a_buf_macro, std::string const &a_name, char const *a_suffix, char const
+void Unpacker::BindSignal(Config &a_config, ItemMap const &a_item_map,
+    std::string const &a_name, char const *a_suffix, char const
     *a_config_suffix, size_t &a_event_buf_i, std::map<std::string, uint32_t>
-    &a_signal_map, bool a_optional)
+    &a_signal_map, bool a_optional, bool a_do_bind)
 {
-  // Find signal in macro.
+  // Find signal in struct.
   std::string full_name = a_name + (a_suffix ? a_suffix : "");
   auto it = a_signal_map.find(full_name);
   if (a_signal_map.end() != it) {
     return;
   }
   auto ret = a_signal_map.insert(std::make_pair(full_name, 0));
-  char const *p = &a_buf_macro.at(0);
-  for (;; ++p) {
-    p = strstr(p, full_name.c_str());
-    if (!p) {
-      if (a_optional) {
-        return;
-      }
-      std::cerr << full_name << ": mandatory signal not mapped.\n";
-      throw std::runtime_error(__func__);
-    }
-    if (',' == p[full_name.size()]) {
-      break;
+  auto item_it = a_item_map.find(full_name);
+  if (a_item_map.end() == item_it) {
+    if (a_optional) {
+      return;
     }
-  }
-
-  // Find macro name.
-  auto macro = RewindNewline(a_buf_macro, p);
-  macro = RewindNewline(a_buf_macro, macro - 1);
-  macro = strstr(macro, "EXT_STR_ITEM_INFO");
-  if (!macro || macro > p) {
-    std::cerr << full_name << ": missing struct-info macro name.\n";
+    std::cerr << full_name << ": mandatory signal not mapped.\n";
     throw std::runtime_error(__func__);
   }
+  auto const &item = item_it->second;
 
   // Find type.
-  p += full_name.size() + 1;
-  for (; isblank(*p); ++p)
-    ;
   int struct_info_type;
   Type output_type;
   size_t in_type_bytes;
   size_t arr_n;
-  if (MATCH_WORD(p, "UINT32,")) {
+  if ("UINT32" == item.type) {
     struct_info_type = EXT_DATA_ITEM_TYPE_UINT32;
     output_type = kUint64;
     in_type_bytes = sizeof(uint32_t);
   } else {
-    auto q = p;
-    for (; isalnum(*p); ++p)
-      ;
-    std::string str(q, static_cast<size_t>(p - q));
-    std::cerr << full_name << ": unsupported type '" << str << "'.\n";
-    throw std::runtime_error(__func__);
-  }
-  std::string full_name_ptn = "\"";
-  full_name_ptn += full_name + "\"";
-  p = strstr(p, full_name_ptn.c_str());
-  if (!p) {
-    std::cerr << full_name << ": could not find max value/reference.\n";
+    std::cerr << full_name << ": unsupported type '" << item.type <<
+        "'.\n";
     throw std::runtime_error(__func__);
   }
 
   // Find array size.
-  p += full_name_ptn.size() + 1;
   std::string ctrl;
   if (!a_suffix || 0 == strcmp("M", a_suffix)) {
     // If no suffix = "" or "M", find max value, possibly future array limit.
-    char *end;
     // Can be unlimited scalar, limit = 0.
-    ret.first->second = static_cast<uint32_t>(strtol(p, &end, 10));
+    ret.first->second = static_cast<uint32_t>(strtol(item.arg.c_str(),
+        nullptr, 10));
     arr_n = 1;
   } else {
     // Otherwise find reference limit.
-    for (; isblank(*p); ++p)
-      ;
-    auto q = p + 1;
-    if ('"' == *p) {
-      for (++p; isalnum(*p) || '_' == *p; ++p)
-        ;
-    }
-    if ('"' != *p) {
+    auto const &arg = item.arg;
+    if (arg.size() < 3 || '"' != arg.front() || '"' != arg.back()) {
       std::cerr << full_name << ": could not find reference.\n";
       throw std::runtime_error(__func__);
     }
-    ctrl = std::string(q, static_cast<size_t>(p - q));
+    ctrl = arg.substr(1, arg.size() - 2);
     auto it2 = a_signal_map.find(ctrl);
     if (a_signal_map.end() == it2) {
       std::cerr << full_name << ": reference '" << ctrl << "' not seen.\n";
@@ -291,32 +349,25 @@ void Unpacker::BindSignal(Config &a_config, std::vector<char> const
   auto in_bytes = in_type_bytes * arr_n;
   // 32-bit align.
   a_event_buf_i = (a_event_buf_i + 3U) & ~3U;
-  a_config.BindSignal(a_name, a_config_suffix, m_map.size(), output_type);
-
-  std::cout << full_name << ": " << a_event_buf_i << ' ' << in_type_bytes <<
-      '*' << arr_n << '\n';
+  if (a_do_bind) {
+    a_config.BindSignal(a_name, a_config_suffix, m_map.size(), output_type);
+  }
 
   // Setup links.
   int ok = 1;
-  if (MATCH_WORD(macro, "EXT_STR_ITEM_INFO") ||
-      MATCH_WORD(macro, "EXT_STR_ITEM_INFO2")) {
+  auto const &macro = item.macro;
+  if ("EXT_STR_ITEM_INFO" == macro || "EXT_STR_ITEM_INFO2" == macro) {
     // Unlimited scalar.
-std::cout << "0: " << a_event_buf_i << ' ' << in_bytes << ' ' <<
-struct_info_type << ' ' << full_name << '\n';
     ok &= 0 == ext_data_struct_info_item(m_struct_info, a_event_buf_i,
         in_bytes, struct_info_type, "", -1, full_name.c_str(), "", -1, 0);
-  } else if (MATCH_WORD(macro, "EXT_STR_ITEM_INFO_LIM") ||
-      MATCH_WORD(macro, "EXT_STR_ITEM_INFO2_LIM")) {
+  } else if ("EXT_STR_ITEM_INFO_LIM" == macro ||
+      "EXT_STR_ITEM_INFO2_LIM" == macro) {
     // Limited scalar.
-std::cout << "1: " << a_event_buf_i << ' ' << in_bytes << ' ' <<
-struct_info_type << ' ' << full_name << ' ' << ret.first->second << '\n';
     ok &= 0 == ext_data_struct_info_item(m_struct_info, a_event_buf_i,
         in_bytes, struct_info_type, "", -1, full_name.c_str(), "",
         static_cast<int>(ret.first->second), 0);
-  } else if (MATCH_WORD(macro, "EXT_STR_ITEM_INFO_ZZP") ||
-      MATCH_WORD(macro, "EXT_STR_ITEM_INFO2_ZZP")) {
-std::cout << "2: " << a_event_buf_i << ' ' << in_bytes << ' ' <<
-struct_info_type << ' ' << full_name << ' ' << ctrl << '\n';
+  } else if ("EXT_STR_ITEM_INFO_ZZP" == macro ||
+      "EXT_STR_ITEM_INFO2_ZZP" == macro) {
     ok &= 0 == ext_data_struct_info_item(m_struct_info, a_event_buf_i,
         in_bytes, struct_info_type, "", -1, full_name.c_str(), ctrl.c_str(),
         -1, 0);
@@ -330,28 +381,108 @@ struct_info_type << ' ' << full_name << ' ' << ctrl << '\n';
     throw std::runtime_error(__func__);
   }
 
-  m_map.push_back(Entry(struct_info_type, a_event_buf_i, m_out_size, arr_n));
+  auto ctrl_i = kNoCtrl;
+  if (!ctrl.empty()) {
+    for (size_t i = 0; i < m_map.size(); ++i) {
+      if (ctrl == m_map[i].name) {
+        ctrl_i = i;
+        break;
+      }
+    }
+    if (kNoCtrl == ctrl_i || 1 != m_map[ctrl_i].len) {
+      std::cerr << full_name << ": reference '" << ctrl <<
+          "' not a bound scalar.\n";
+      throw std::runtime_error(__func__);
+    }
+  }
+  m_map.push_back(Entry(full_name, struct_info_type, a_event_buf_i,
+      m_out_size, arr_n, ctrl_i));
 
   a_event_buf_i += in_bytes;
-  ++m_out_size;
+  m_out_size += arr_n;
+}
+
+void Unpacker::Buffer(unsigned a_slot)
+{
+  // Keep the raw event, entries are converted on request.
+  m_raw_buf.at(a_slot).swap(m_event_buf);
+  ++m_slot_gen[a_slot];
 }
 
-void Unpacker::Buffer()
+void Unpacker::Clear(std::vector<uint8_t> *a_buf)
 {
-  // Convert ucesb event-buffer.
+  // Only items without a control item need clearing, arrays are read up to
+  // their control item which is cleared here.
   for (auto it = m_map.begin(); m_map.end() != it; ++it) {
+    if (kNoCtrl == it->ctrl_i) {
+      memset(&(*a_buf)[it->in_ofs], 0, it->len * sizeof(uint32_t));
+    }
+  }
+}
+
+bool Unpacker::Connect(size_t a_part_i)
+{
+  // A fresh client per connection, a restarted server starts over with a
+  // new header and whole events.
+  auto &clnt = m_clnt_vec.at(a_part_i);
+  delete clnt;
+  clnt = new ext_data_clnt;
+  if (m_server.empty()) {
+    auto fd = fileno(m_pip_vec.at(a_part_i));
+    if (-1 == fd) {
+      perror("fileno");
+      return false;
+    }
+    if (!clnt->connect(fd)) {
+      perror("ext_data_clnt::ext_data_from_fd");
+      return false;
+    }
+  } else if (!clnt->connect(m_server.c_str())) {
+    perror("ext_data_clnt::connect");
+    std::cerr << m_server << ": Could not connect.\n";
+    return false;
+  }
+  uint32_t success = 0;
+  if (-1 == clnt->setup(nullptr, 0, &m_struct_info, &success,
+      m_event_buf.size())) {
+    perror("ext_data_clnt::setup");
+    std::cerr << clnt->last_error() << '\n';
+    return false;
+  }
+  uint32_t map_ok = EXT_DATA_ITEM_MAP_OK | EXT_DATA_ITEM_MAP_NO_DEST;
+  if (success & ~map_ok) {
+    // Reconnecting won't fix a struct mismatch.
+    perror("ext_data_clnt::setup");
+    ext_data_struct_info_print_map_success(m_struct_info, stderr, map_ok);
+    throw std::runtime_error(__func__);
+  }
+  return true;
+}
+
+void Unpacker::Convert(unsigned a_slot, size_t a_id)
+{
+  // Convert ucesb event-buffer, arrays only up to their control item.
+  auto const &raw_buf = m_raw_buf[a_slot];
+  auto it = &m_map.at(a_id);
+  auto len = it->len;
+  if (kNoCtrl != it->ctrl_i) {
+    auto const &ctrl = m_map[it->ctrl_i];
+    size_t n = *(uint32_t const *)&raw_buf[ctrl.in_ofs];
+    len = std::min(len, n);
+  }
+  m_out_len[a_slot][a_id] = len;
 #define COPY_BUF_TYPE(TYPE, in_type, out_member) do { \
     if (EXT_DATA_ITEM_TYPE_##TYPE == it->ext_type) { \
-      auto pin = (in_type const *)&m_event_buf[it->in_ofs]; \
-      auto pout = &m_out_buf[it->out_ofs]; \
-      for (size_t i = 0; i < it->len; ++i) { \
+      auto pin = (in_type const *)&raw_buf[it->in_ofs]; \
+      auto pout = &m_out_buf[a_slot][it->out_ofs]; \
+      for (size_t i = 0; i < len; ++i) { \
         pout->out_member = *pin++; \
         ++pout; \
       } \
     } \
   } while (0)
-    COPY_BUF_TYPE(UINT32, uint32_t, u64);
-  }
+  COPY_BUF_TYPE(UINT32, uint32_t, u64);
+  m_conv_gen[a_slot][a_id] = m_slot_gen[a_slot];
 }
 
 std::vector<char> Unpacker::ExtractRange(std::vector<char> const &a_buf, char
@@ -376,36 +507,361 @@ std::vector<char> Unpacker::ExtractRange(std::vector<char> const &a_buf, char
 
 bool Unpacker::Fetch()
 {
-  memset(m_event_buf.data(), 0, m_event_buf.size());
-  auto ret = m_clnt->fetch_event(m_event_buf.data(), m_event_buf.size());
-  if (0 == ret) {
-    return false;
+  if (!m_is_merged) {
+    if (m_part_thread_vec.empty()) {
+      return kPartDone != m_part_state[0] && FetchPart(0, &m_event_buf);
+    }
+    // Unordered, take whatever part delivered first.
+    std::unique_lock<std::mutex> lock(m_part_mutex);
+    m_part_cv.wait(lock, [this]{
+        return !m_part_ready.empty() || m_part_error || m_part_stop ||
+            m_part_thread_vec.size() == m_part_done_n;
+    });
+    if (m_part_stop) {
+      return false;
+    }
+    if (m_part_error) {
+      std::cerr << m_path << ": Unpacker part failed.\n";
+      throw std::runtime_error(__func__);
+    }
+    if (m_part_ready.empty()) {
+      return false;
+    }
+    m_part_free.push_back(std::vector<uint8_t>());
+    m_part_free.back().swap(m_event_buf);
+    m_event_buf.swap(m_part_ready.front());
+    m_part_ready.pop_front();
+    lock.unlock();
+    m_part_cv.notify_all();
+    return true;
   }
-  if (-1 == ret) {
-    perror("ext_data_clnt::fetch_event");
-    throw std::runtime_error(__func__);
+  // Ordered, every part keeps its next event pending and the earliest one
+  // is taken.
+  auto min_i = kNoCtrl;
+  uint64_t min_ts = 0;
+  for (size_t i = 0; i < m_clnt_vec.size(); ++i) {
+    if (kPartIdle == m_part_state[i] && FetchPart(i, &m_part_buf[i])) {
+      m_part_state[i] = kPartPending;
+    }
+    if (kPartPending == m_part_state[i]) {
+      auto ts = Timestamp(m_part_buf[i]);
+      if (kNoCtrl == min_i || ts < min_ts) {
+        min_i = i;
+        min_ts = ts;
+      }
+    }
+  }
+  if (kNoCtrl == min_i) {
+    return false;
   }
+  m_event_buf.swap(m_part_buf[min_i]);
+  m_part_state[min_i] = kPartIdle;
   return true;
 }
 
-std::pair<Input::Scalar const *, size_t> Unpacker::GetData(size_t a_id)
+bool Unpacker::FetchPart(size_t a_part_i, std::vector<uint8_t> *a_buf)
+{
+  if (!m_server.empty()) {
+    if (m_server_link.Fetch(a_buf)) {
+      return true;
+    }
+    m_part_state[a_part_i] = kPartDone;
+    return false;
+  }
+  Clear(a_buf);
+  auto ret = m_clnt_vec[a_part_i]->fetch_event(a_buf->data(),
+      a_buf->size());
+  if (0 != ret && -1 != ret) {
+    return true;
+  }
+  // A stopped unpacker was killed, whatever the client made of that.
+  if (0 == ret || IsStopped()) {
+    m_part_state[a_part_i] = kPartDone;
+    return false;
+  }
+  perror("ext_data_clnt::fetch_event");
+  throw std::runtime_error(__func__);
+}
+
+void Unpacker::PartThread(size_t a_part_i)
+{
+  std::vector<uint8_t> buf;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(m_part_mutex);
+      m_part_cv.wait(lock, [this]{
+          return m_part_stop || !m_part_free.empty();
+      });
+      if (m_part_stop) {
+        return;
+      }
+      buf.swap(m_part_free.back());
+      m_part_free.pop_back();
+    }
+    bool ok = false;
+    bool is_error = false;
+    try {
+      ok = FetchPart(a_part_i, &buf);
+    } catch (std::exception const &) {
+      is_error = true;
+    }
+    {
+      std::lock_guard<std::mutex> lock(m_part_mutex);
+      if (ok) {
+        m_part_ready.push_back(std::vector<uint8_t>());
+        m_part_ready.back().swap(buf);
+      } else {
+        ++m_part_done_n;
+        if (is_error) {
+          m_part_error = true;
+        }
+      }
+    }
+    m_part_cv.notify_all();
+    if (!ok) {
+      return;
+    }
+  }
+}
+
+std::pair<Input::Scalar const *, size_t> Unpacker::GetData(unsigned a_slot,
+    size_t a_id)
 {
   auto &entry = m_map.at(a_id);
-  return std::make_pair(&m_out_buf.at(entry.out_ofs), entry.len);
+  if (m_conv_gen.at(a_slot)[a_id] != m_slot_gen[a_slot]) {
+    Convert(a_slot, a_id);
+  }
+  return std::make_pair(&m_out_buf[a_slot].at(entry.out_ofs),
+      m_out_len[a_slot][a_id]);
 }
 
+bool Unpacker::IsStopped()
+{
+  std::lock_guard<std::mutex> lock(m_part_mutex);
+  return m_part_stop;
+}
 
-char const *Unpacker::RewindNewline(std::vector<char> const &a_buf, char const
-    *a_p)
+Unpacker::ItemMap Unpacker::LoadItems(std::string const &a_signals_str)
 {
-  auto p = a_p;
-  for (; '\n' != *p; --p) {
-    if (&a_buf.at(0) >= p) {
-      std::cerr << "No newline found.\n";
+  // Resolve the unpacker here, its binary keys the cache.
+  wordexp_t exp = {0};
+  if (0 != wordexp(m_path.c_str(), &exp, 0)) {
+    perror("wordexp");
+    throw std::runtime_error(__func__);
+  }
+  if (1 != exp.we_wordc) {
+    std::cerr << m_path << ": Does not resolve to single unpacker.\n";
+    wordfree(&exp);
+    throw std::runtime_error(__func__);
+  }
+  std::string path = exp.we_wordv[0];
+  wordfree(&exp);
+  struct stat st;
+  if (-1 == stat(path.c_str(), &st)) {
+    perror(path.c_str());
+    throw std::runtime_error(__func__);
+  }
+  std::ostringstream key;
+  key << path << ' ' << st.st_size << ' ' << st.st_mtime << ' ' <<
+      a_signals_str;
+  std::ostringstream cache_oss;
+  cache_oss << CacheDir() << "/struct_" << std::hex <<
+      std::hash<std::string>()(key.str()) << ".txt";
+  auto cache_path = cache_oss.str();
+
+  // Cache: magic, key, then one "name macro type arg" line per item.
+  ItemMap item_map;
+  {
+    std::ifstream ifile(cache_path.c_str());
+    std::string magic, file_key;
+    std::getline(ifile, magic);
+    std::getline(ifile, file_key);
+    if (ifile && STRUCT_CACHE_MAGIC == magic && key.str() == file_key) {
+      std::string name;
+      Item item;
+      while (ifile >> name >> item.macro >> item.type >> item.arg) {
+        item_map[name] = item;
+      }
+      if (ifile.eof()) {
+        std::cout << cache_path << ": Cached struct, " << item_map.size() <<
+            " items.\n";
+        return item_map;
+      }
+      item_map.clear();
+    }
+  }
+
+  // Generate struct file.
+  auto temp_path_c = strdup("pluttXXXXXX.h");
+  auto fd = mkstemps(temp_path_c, 2);
+  if (-1 == fd) {
+    perror("mkstemps");
+    free(temp_path_c);
+    throw std::runtime_error(__func__);
+  }
+  close(fd);
+  std::string temp_path(temp_path_c);
+  free(temp_path_c);
+  auto pid = fork();
+  if (-1 == pid) {
+    perror("fork");
+    remove(temp_path.c_str());
+    throw std::runtime_error(__func__);
+  }
+  if (0 == pid) {
+    std::ostringstream oss;
+    oss << "--ntuple=STRUCT_HH," << a_signals_str << "id=plutt," <<
+        temp_path;
+    std::cout << "Struct call: " << path << ' ' << path << ' ' << oss.str() <<
+        '\n';
+    execl(path.c_str(), path.c_str(), oss.str().c_str(), nullptr);
+    perror("exec");
+    _exit(EXIT_FAILURE);
+  } else {
+    int status = 0;
+    if (-1 == wait(&status)) {
+      perror("wait");
+      remove(temp_path.c_str());
       throw std::runtime_error(__func__);
     }
+    if (!WIFEXITED(status) || 0 != WEXITSTATUS(status)) {
+      std::cerr << m_path << ": failed to get struct.\n";
+      remove(temp_path.c_str());
+      throw std::runtime_error(__func__);
+    }
+  }
+
+  // Prepare parsing of struct.
+  if (-1 == stat(temp_path.c_str(), &st)) {
+    perror("stat");
+    throw std::runtime_error(__func__);
+  }
+  std::vector<char> buf_file(static_cast<size_t>(st.st_size) + 1);
+  std::ifstream ifile(temp_path.c_str());
+  ifile.read(&buf_file.at(0), st.st_size);
+  ifile.close();
+  remove(temp_path.c_str());
+
+  item_map = ParseItems(ExtractRange(buf_file, "_ITEMS_INFO", " while (0)"));
+
+  // Write through a temp name, several plutts may race for the same cache.
+  std::ostringstream tmp_path;
+  tmp_path << cache_path << '.' << getpid();
+  {
+    std::ofstream ofile(tmp_path.str().c_str());
+    ofile << STRUCT_CACHE_MAGIC << '\n' << key.str() << '\n';
+    for (auto it = item_map.begin(); item_map.end() != it; ++it) {
+      ofile << it->first << ' ' << it->second.macro << ' ' <<
+          it->second.type << ' ' << it->second.arg << '\n';
+    }
+    if (!ofile) {
+      std::cerr << tmp_path.str() << ": Could not write struct cache.\n";
+    }
+  }
+  if (0 != rename(tmp_path.str().c_str(), cache_path.c_str())) {
+    perror(cache_path.c_str());
+    remove(tmp_path.str().c_str());
+  }
+  return item_map;
+}
+
+Unpacker::ItemMap Unpacker::ParseItems(std::vector<char> const &a_buf_macro)
+{
+  // Every item looks like, over lines with continuations:
+  //  EXT_STR_ITEM_INFO*(ok,si,offset,struct_t,printerr, name, type,
+  //    "name"[, limit or "ctrl"[, more]]);
+  ItemMap item_map;
+  char const *p = &a_buf_macro.at(0);
+  for (;;) {
+    p = strstr(p, "EXT_STR_ITEM_INFO");
+    if (!p) {
+      break;
+    }
+    auto q = p;
+    for (; isalnum(*p) || '_' == *p; ++p)
+      ;
+    std::string macro(q, static_cast<size_t>(p - q));
+    for (; isspace(*p); ++p)
+      ;
+    if ('(' != *p) {
+      continue;
+    }
+    // Split arguments, dropping blanks and line continuations.
+    std::vector<std::string> arg_vec(1);
+    for (++p; '\0' != *p && ')' != *p; ++p) {
+      if (',' == *p) {
+        arg_vec.push_back("");
+      } else if (!isspace(*p) && '\\' != *p) {
+        arg_vec.back() += *p;
+      }
+    }
+    if (arg_vec.size() < 8 || arg_vec[5].empty() || arg_vec[6].empty()) {
+      std::cerr << macro << ": Unexpected struct-info arguments.\n";
+      throw std::runtime_error(__func__);
+    }
+    Item item;
+    item.macro = macro;
+    item.type = arg_vec[6];
+    // Unlimited scalars may have no limit.
+    item.arg = arg_vec.size() > 8 && !arg_vec[8].empty() ? arg_vec[8] : "0";
+    item_map[arg_vec[5]] = item;
+  }
+  return item_map;
+}
+
+Unpacker::ServerClient::ServerClient(Unpacker *a_unpacker):
+  m_unpacker(a_unpacker)
+{
+}
+
+bool Unpacker::ServerClient::Connect()
+{
+  return !m_unpacker->IsStopped() && m_unpacker->Connect(0);
+}
+
+int Unpacker::ServerClient::Fetch(std::vector<uint8_t> *a_buf)
+{
+  m_unpacker->Clear(a_buf);
+  auto ret = m_unpacker->m_clnt_vec.at(0)->fetch_event(a_buf->data(),
+      a_buf->size());
+  if (-1 == ret) {
+    perror("ext_data_clnt::fetch_event");
+  }
+  return ret;
+}
+
+bool Unpacker::ServerClient::Pause()
+{
+  auto u = m_unpacker;
+  std::unique_lock<std::mutex> lock(u->m_part_mutex);
+  return !u->m_part_cv.wait_for(lock, std::chrono::seconds(1), [u]{
+      return u->m_part_stop;
+  });
+}
+
+void Unpacker::Stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_part_mutex);
+    if (m_part_stop) {
+      return;
+    }
+    m_part_stop = true;
+  }
+  m_part_cv.notify_all();
+  // Readers may be blocked in fetch_event, end their streams.
+  for (auto it = m_pid_vec.begin(); m_pid_vec.end() != it; ++it) {
+    kill(*it, SIGTERM);
+  }
+}
+
+uint64_t Unpacker::Timestamp(std::vector<uint8_t> const &a_buf) const
+{
+  uint64_t ts = *(uint32_t const *)&a_buf[m_map[m_ts_lo_i].in_ofs];
+  if (kNoCtrl != m_ts_hi_i) {
+    ts |= (uint64_t)*(uint32_t const *)&a_buf[m_map[m_ts_hi_i].in_ofs] << 32;
   }
-  return p;
+  return ts;
 }
 
 #endif
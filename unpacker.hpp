@@ -24,13 +24,19 @@
 #ifndef UNPACKER_HPP
 #define UNPACKER_HPP
 
+#include <condition_variable>
+#include <deque>
 #include <map>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
+#include <sys/types.h>
 #include <ext_data_client.h>
 #include <ext_data_struct_info.hh>
 #include <ext_data_clnt.hh>
 #include <input.hpp>
+#include <server_link.hpp>
 
 class Config;
 
@@ -41,46 +47,147 @@ class Config;
  *  argv[0] = path to the unpacker,
  *  argv[1] = lmd,
  *  argv[2] = --allow-errors etc.
+ * The unsigned is the number of output slots, see input.hpp.
+ * With a server, "host[:port]", the local unpacker only provides the struct
+ * layout and events come from a ucesb struct server, which is reconnected to
+ * when it restarts. Remaining arguments are then ignored.
+ * With several parts, the struct is found once and as many unpackers are
+ * started, each with every part-th file and all other arguments. Files are
+ * the arguments naming existing files, ucesb input options such as
+ * --stream= cannot be split and are refused. Every part has a reader thread,
+ * and events are taken from whichever part has one ready, or, given
+ * "lo[,hi]" timestamp signals, in timestamp order assuming every part is
+ * ordered.
  */
 class Unpacker: public Input {
   public:
-    Unpacker(Config &, int, char **);
+    Unpacker(Config &, unsigned, int, char **, char const * = nullptr,
+        unsigned = 1, char const * = nullptr);
     ~Unpacker();
-    void Buffer();
+    void Buffer(unsigned);
     bool Fetch();
-    std::pair<Input::Scalar const *, size_t> GetData(size_t);
+    std::pair<Input::Scalar const *, size_t> GetData(unsigned, size_t);
+    // Also terminates the unpackers, so readers blocked on them return.
+    void Stop();
 
   private:
     Unpacker(Unpacker const &);
     Unpacker &operator=(Unpacker const &);
-    void BindSignal(Config &, std::vector<char> const &, std::string const &,
-        char const *, char const *, size_t &, std::map<std::string, uint32_t>
-        &, bool);
+    // Struct-info item by member name, from the _ITEMS_INFO macro.
+    struct Item {
+      Item():
+        macro(),
+        type(),
+        arg()
+      {
+      }
+      std::string macro;
+      std::string type;
+      // Max value for scalars, "ctrl" for arrays.
+      std::string arg;
+    };
+    typedef std::map<std::string, Item> ItemMap;
+    void BindSignal(Config &, ItemMap const &, std::string const &, char
+        const *, char const *, size_t &, std::map<std::string, uint32_t> &,
+        bool, bool);
     std::vector<char> ExtractRange(std::vector<char> const &, char const *,
         char const *);
-    char const *RewindNewline(std::vector<char> const &, char const *);
+    // Struct-info of the unpacker for the signals, cached by the unpacker
+    // binary and the signals so a restart doesn't need to run it.
+    ItemMap LoadItems(std::string const &);
+    static ItemMap ParseItems(std::vector<char> const &);
+    bool Connect(size_t);
+    void Clear(std::vector<uint8_t> *);
+    bool FetchPart(size_t, std::vector<uint8_t> *);
+    bool IsStopped();
+    void PartThread(size_t);
+    uint64_t Timestamp(std::vector<uint8_t> const &) const;
 
+    // One try per second.
+    static unsigned const kReconnectTries = 60;
+    // Event buffers per part for the reader threads.
+    static unsigned const kPartBufN = 4;
     std::string m_path;
-    ext_data_clnt *m_clnt;
-    FILE *m_pip;
+    std::string m_server;
+    // One client and pipe per part, the pipe is null for a server, and the
+    // unpacker process behind every pipe.
+    std::vector<ext_data_clnt *> m_clnt_vec;
+    std::vector<FILE *> m_pip_vec;
+    std::vector<pid_t> m_pid_vec;
+    // The server connection as seen by the reconnect loop.
+    class ServerClient: public ServerLink::Client {
+      public:
+        explicit ServerClient(Unpacker *);
+        bool Connect();
+        int Fetch(std::vector<uint8_t> *);
+        bool Pause();
+
+      private:
+        ServerClient(ServerClient const &);
+        ServerClient &operator=(ServerClient const &);
+
+        Unpacker *m_unpacker;
+    };
+    ServerClient m_server_client;
+    ServerLink m_server_link;
+    // When merged, every part keeps its next event pending with its
+    // timestamp items in m_map.
+    enum PartState {
+      kPartIdle,
+      kPartPending,
+      kPartDone
+    };
+    std::vector<PartState> m_part_state;
+    std::vector<std::vector<uint8_t>> m_part_buf;
+    // Unordered parts: reader threads take free buffers and queue them
+    // filled, Fetch takes the first ready one.
+    std::vector<std::thread> m_part_thread_vec;
+    std::mutex m_part_mutex;
+    std::condition_variable m_part_cv;
+    std::vector<std::vector<uint8_t>> m_part_free;
+    std::deque<std::vector<uint8_t>> m_part_ready;
+    size_t m_part_done_n;
+    bool m_part_error;
+    // Set by Stop, also ends the pause between server connection tries.
+    bool m_part_stop;
+    bool m_is_merged;
+    size_t m_ts_lo_i;
+    size_t m_ts_hi_i;
     ext_data_struct_info m_struct_info;
+    // Arrays with a control item only hold as many entries as given by the
+    // control item, ctrl_i is its index in m_map or kNoCtrl.
     struct Entry {
-      Entry(int a_ext_type, size_t a_in_ofs, size_t a_out_ofs, size_t a_len):
+      Entry(std::string const &a_name, int a_ext_type, size_t a_in_ofs,
+          size_t a_out_ofs, size_t a_len, size_t a_ctrl_i):
+        name(a_name),
         ext_type(a_ext_type),
         in_ofs(a_in_ofs),
         out_ofs(a_out_ofs),
-        len(a_len)
+        len(a_len),
+        ctrl_i(a_ctrl_i)
       {
       }
+      std::string name;
       int ext_type;
       size_t in_ofs;
       size_t out_ofs;
       size_t len;
+      size_t ctrl_i;
     };
+    static size_t const kNoCtrl = (size_t)-1;
     std::vector<Entry> m_map;
+    void Convert(unsigned, size_t);
+
+    // Fetch target, swapped with the raw buffer of a slot by Buffer.
     std::vector<uint8_t> m_event_buf;
     size_t m_out_size;
-    std::vector<Input::Scalar> m_out_buf;
+    // Per slot: the raw event, the output buffer, # of converted entries,
+    // and the event generation each entry was converted for.
+    std::vector<std::vector<uint8_t>> m_raw_buf;
+    std::vector<std::vector<Input::Scalar>> m_out_buf;
+    std::vector<std::vector<size_t>> m_out_len;
+    std::vector<uint64_t> m_slot_gen;
+    std::vector<std::vector<uint64_t>> m_conv_gen;
 };
 
 #endif
@@ -20,11 +20,16 @@
  */
 
 #include <util.hpp>
+#include <sys/stat.h>
 #include <dirent.h>
 #include <err.h>
 #include <cassert>
+#include <cerrno>
 #include <cmath>
+#include <cstdlib>
+#include <iostream>
 #include <mutex>
+#include <stdexcept>
 #include <string>
 #include <thread>
 #include <SDL_timer.h>
@@ -33,6 +38,32 @@ namespace {
   uint64_t g_time_ms;
 }
 
+std::string CacheDir()
+{
+  std::string dir;
+  auto xdg = getenv("XDG_CACHE_HOME");
+  if (xdg && *xdg) {
+    dir = xdg;
+  } else {
+    auto home = getenv("HOME");
+    if (!home || !*home) {
+      std::cerr << "Neither XDG_CACHE_HOME nor HOME set!\n";
+      throw std::runtime_error(__func__);
+    }
+    dir = std::string(home) + "/.cache";
+  }
+  for (unsigned i = 0; i < 2; ++i) {
+    if (0 != mkdir(dir.c_str(), 0755) && EEXIST != errno) {
+      perror(dir.c_str());
+      throw std::runtime_error(__func__);
+    }
+    if (0 == i) {
+      dir += "/plutt";
+    }
+  }
+  return dir;
+}
+
 LinearTransform::LinearTransform(double a_k, double a_m):
   m_k(a_k),
   m_m(a_m)
@@ -28,6 +28,10 @@
 
 #define LENGTH(x) (sizeof x / sizeof *x)
 
+// Per-user cache directory, $XDG_CACHE_HOME/plutt or ~/.cache/plutt,
+// created if needed.
+std::string CacheDir();
+
 class LinearTransform {
   public:
     LinearTransform(double, double);
@@ -75,19 +75,35 @@ Vector<Input::Scalar> const &Value::GetV() const
   return m_v;
 }
 
+Span<uint32_t> Value::GetMISpan() const
+{
+  return m_mi.span();
+}
+
+Span<uint32_t> Value::GetMESpan() const
+{
+  return m_me.span();
+}
+
+Span<Input::Scalar> Value::GetVSpan() const
+{
+  return m_v.span();
+}
+
 double Value::GetV(uint32_t a_i, bool a_do_signed) const
 {
+  auto v = m_v.span();
   switch (m_type) {
     case Input::kUint64:
       {
-        auto u64 = m_v.at(a_i).u64;
+        auto u64 = v[a_i].u64;
         if (a_do_signed) {
           return (double)(int64_t)u64;
         }
         return (double)u64;
       }
     case Input::kDouble:
-      return m_v.at(a_i).dbl;
+      return v[a_i].dbl;
     default:
       throw std::runtime_error(__func__);
   }
@@ -105,6 +121,13 @@ void Value::Push(uint32_t a_i, Input::Scalar const &a_v)
   m_v.push_back(a_v);
 }
 
+void Value::Reserve(size_t a_mi_n, size_t a_v_n)
+{
+  m_mi.reserve(a_mi_n);
+  m_me.reserve(a_mi_n);
+  m_v.reserve(a_v_n);
+}
+
 void Value::SetType(Input::Type a_type)
 {
   if (Input::kNone != m_type && a_type != m_type) {
@@ -39,11 +39,17 @@ class Value {
     Vector<uint32_t> const &GetMI() const;
     Vector<uint32_t> const &GetME() const;
     Vector<Input::Scalar> const &GetV() const;
+    // Spans for hot loops, checked only in debug builds, see vector.hpp.
+    Span<uint32_t> GetMISpan() const;
+    Span<uint32_t> GetMESpan() const;
+    Span<Input::Scalar> GetVSpan() const;
     // Converts whatever v-type to double. This is online, not paper plots,
     // but developers need to be careful still!
     double GetV(uint32_t, bool) const;
     // Pushes scalar to given channel.
     void Push(uint32_t, Input::Scalar const &);
+    // Hints # of channels and # of values to come, avoids re-allocations.
+    void Reserve(size_t, size_t);
     void SetType(Input::Type);
 
   private:
@@ -53,4 +59,29 @@ class Value {
     Vector<Input::Scalar> m_v;
 };
 
+/*
+ * Same conversions as Value::GetV(i, signed), but resolved at compile time.
+ * Nodes switch on the value type once per event and instantiate their inner
+ * loops per type, e.g.:
+ *   case Input::kUint64: Kernel<uint64_t>(val.GetVSpan()); break;
+ * and in the kernel:
+ *   auto d = ValueToDouble<T, false>::Get(v[i]);
+ */
+template <typename T, bool do_signed> struct ValueToDouble;
+template <bool do_signed> struct ValueToDouble<double, do_signed> {
+  static double Get(Input::Scalar const &a_s) {
+    return a_s.dbl;
+  }
+};
+template <> struct ValueToDouble<uint64_t, false> {
+  static double Get(Input::Scalar const &a_s) {
+    return (double)a_s.u64;
+  }
+};
+template <> struct ValueToDouble<uint64_t, true> {
+  static double Get(Input::Scalar const &a_s) {
+    return (double)(int64_t)a_s.u64;
+  }
+};
+
 #endif
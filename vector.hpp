@@ -22,10 +22,61 @@
 #ifndef VECTOR_HPP
 #define VECTOR_HPP
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <stdexcept>
 
+// Read-only view of contiguous elements for the inner loops of nodes.
+// Indexing is bounds-checked unless built with PLUTT_UNCHECKED, which the
+// release build mode defines.
+template <class T>
+class Span {
+  public:
+    typedef T const *it;
+
+    Span():
+      m_array(),
+      m_size() {
+    }
+    Span(T const *a_array, size_t a_size):
+      m_array(a_array),
+      m_size(a_size) {
+    }
+    T const &back() const {
+#ifndef PLUTT_UNCHECKED
+      if (0 == m_size) {
+        throw std::runtime_error("Span.back on empty span.");
+      }
+#endif
+      return m_array[m_size - 1];
+    }
+    it begin() const {
+      return m_array;
+    }
+    bool empty() const {
+      return 0 == m_size;
+    }
+    it end() const {
+      return m_array ? &m_array[m_size] : nullptr;
+    }
+    size_t size() const {
+      return m_size;
+    }
+    T const &operator[](size_t a_i) const {
+#ifndef PLUTT_UNCHECKED
+      if (a_i >= m_size) {
+        throw std::runtime_error("Span overflow.");
+      }
+#endif
+      return m_array[a_i];
+    }
+
+  private:
+    T const *m_array;
+    size_t m_size;
+};
+
 // Stupid fast vector version that only grows, never shrinks. It's so stupid
 // you shouldn't use it unless you know what you're doing, and maybe not even
 // then.
@@ -74,6 +125,9 @@ class Vector {
     it const begin() const {
       return m_array;
     }
+    size_t capacity() const {
+      return m_capacity;
+    }
     void clear() {
       m_size = 0;
     }
@@ -92,31 +146,27 @@ class Vector {
     }
     void push_back(T const &a_t) {
       if (m_size == m_capacity) {
-        ++m_capacity;
-        auto array = new T [m_capacity];
-        if (m_array) {
-          memcpy(array, m_array, m_size * sizeof(T));
-          delete [] m_array;
-        }
-        m_array = array;
+        Grow(m_size + 1);
       }
       m_array[m_size++] = a_t;
     }
+    void reserve(size_t a_capacity) {
+      if (a_capacity > m_capacity) {
+        Realloc(a_capacity);
+      }
+    }
     void resize(size_t a_size) {
-      if (a_size >= m_capacity) {
-        m_capacity = a_size;
-        auto array = new T [m_capacity];
-        if (m_array) {
-          memcpy(array, m_array, m_size * sizeof(T));
-          delete [] m_array;
-        }
-        m_array = array;
+      if (a_size > m_capacity) {
+        Grow(a_size);
       }
       m_size = a_size;
     }
     size_t size() const {
       return m_size;
     }
+    Span<T> span() const {
+      return Span<T>(m_array, m_size);
+    }
     T &operator[](size_t a_i) {
       return at(a_i);
     }
@@ -127,6 +177,20 @@ class Vector {
   private:
     Vector(Vector const &);
     Vector &operator=(Vector const &);
+    // Grows geometrically so n pushes cost O(n) copying in total.
+    void Grow(size_t a_min) {
+      Realloc(std::max(a_min, 2 * m_capacity));
+    }
+    void Realloc(size_t a_capacity) {
+      auto array = new T [a_capacity];
+      if (m_array) {
+        // The min is a no-op, but gcc -O3 cannot always see that.
+        memcpy(array, m_array, std::min(m_size, a_capacity) * sizeof(T));
+        delete [] m_array;
+      }
+      m_array = array;
+      m_capacity = a_capacity;
+    }
 
     T *m_array;
     size_t m_capacity;